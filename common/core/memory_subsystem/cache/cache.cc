@@ -1,12 +1,6 @@
 #include "simulator.h"
 #include "cache.h"
 #include "log.h"
-//AMHM Start
-#include <iostream>
-#include <fstream>
-using namespace std;
-#include <iomanip>
-//AMHM End
 
 // Cache class
 // constructors/destructors
@@ -31,10 +25,11 @@ Cache::Cache(
    m_fault_injector(fault_injector)
 {
    m_set_info = CacheSet::createCacheSetInfo(name, cfgname, core_id, replacement_policy, m_associativity);
+   m_block_infos = new CacheBlockInfoArena(m_cache_type, m_num_sets * (m_associativity + 1));
    m_sets = new CacheSet*[m_num_sets];
    for (UInt32 i = 0; i < m_num_sets; i++)
    {
-      m_sets[i] = CacheSet::createCacheSet(cfgname, core_id, replacement_policy, m_cache_type, m_associativity, m_blocksize, m_set_info);
+      m_sets[i] = CacheSet::createCacheSet(cfgname, core_id, replacement_policy, m_cache_type, m_associativity, m_blocksize, m_set_info, m_block_infos, i * m_associativity);
    }
 
    #ifdef ENABLE_SET_USAGE_HIST
@@ -60,23 +55,7 @@ Cache::~Cache()
    for (SInt32 i = 0; i < (SInt32) m_num_sets; i++)
       delete m_sets[i];
    delete [] m_sets;
-   //AMHM Start
-   ofstream outfile;
-   outfile.open("AMHM_FI_stats.log");
-   if(outfile && m_fault_injector) {
-       outfile << "Entry\t\t\t\tStart Address\t\t\tNumber of Reads\t\t\tNumber of Writes\t\t\tNumber of Injected Faults\n";
-       for(int i = 0; i < approx_table_max_entry; i++)
-           if (Sim()->approx_table[i].start_address != 0) {
-                outfile << i << setw(12) << "\t\t\t0x" << hex << setw(12) << Sim()->approx_table[i].start_address\
-                        << "\t\t\t" << dec << setw(12) << Sim()->approx_table[i].numberOfReads << "\t\t\t" << setw(12)\
-                        << Sim()->approx_table[i].numberOfWrites << "\t\t\t"\
-                        << setw(12) <<Sim()->approx_table[i].numberOfInjectedFaults << "\n";
-           }
-       outfile << "\n--------------------------------------------------------------------\n";
-       outfile << "Total number of reads in L2 cache = " << Sim()->numberOfL2Read << "\n";
-       outfile << "Total number of writes in L2 cache = " << Sim()->numberOfL2Write << "\n";
-   }
-   //AMHM End
+   delete m_block_infos;
 }
 
 Lock&
@@ -152,7 +131,10 @@ Cache::insertSingleLine(IntPtr addr, Byte* fill_buff,
    UInt32 set_index;
    splitAddress(addr, tag, set_index);
 
-   CacheBlockInfo* cache_block_info = CacheBlockInfo::create(m_cache_type);
+   // Only its tag is ever changed, so the scratch block info is otherwise still in its initial state.
+   // It is private to this set, so it needs no locking beyond what already serializes insertions into the set:
+   // the cache controller's set lock (CacheMasterCntlr::getSetLock, taken through acquireStackLock), not CacheSet::m_lock
+   CacheBlockInfo* cache_block_info = m_block_infos->get(m_num_sets * m_associativity + set_index);
    cache_block_info->setTag(tag);
 
    m_sets[set_index]->insert(cache_block_info, fill_buff,
@@ -171,8 +153,6 @@ Cache::insertSingleLine(IntPtr addr, Byte* fill_buff,
    #ifdef ENABLE_SET_USAGE_HIST
    ++m_set_usage_hist[set_index];
    #endif
-
-   delete cache_block_info;
 }
 
 
@@ -28,6 +28,8 @@ class Cache : public CacheBase
       cache_t m_cache_type;
       CacheSet** m_sets;
       CacheSetInfo* m_set_info;
+      // Block infos of all sets (num_sets * associativity), followed by one scratch block info per set used for insertion
+      CacheBlockInfoArena* m_block_infos;
 
       FaultInjector *m_fault_injector;
 
@@ -4,6 +4,8 @@
 #include "shared_cache_block_info.h"
 #include "log.h"
 
+#include <new>
+
 const char* CacheBlockInfo::option_names[] =
 {
    "prefetch",
@@ -52,6 +54,46 @@ CacheBlockInfo::create(CacheBase::cache_t cache_type)
    }
 }
 
+CacheBlockInfo*
+CacheBlockInfo::create(CacheBase::cache_t cache_type, void *buffer)
+{
+   switch (cache_type)
+   {
+      case CacheBase::PR_L1_CACHE:
+         return new (buffer) PrL1CacheBlockInfo();
+
+      case CacheBase::PR_L2_CACHE:
+         return new (buffer) PrL2CacheBlockInfo();
+
+      case CacheBase::SHARED_CACHE:
+         return new (buffer) SharedCacheBlockInfo();
+
+      default:
+         LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+         return NULL;
+   }
+}
+
+size_t
+CacheBlockInfo::getSize(CacheBase::cache_t cache_type)
+{
+   switch (cache_type)
+   {
+      case CacheBase::PR_L1_CACHE:
+         return sizeof(PrL1CacheBlockInfo);
+
+      case CacheBase::PR_L2_CACHE:
+         return sizeof(PrL2CacheBlockInfo);
+
+      case CacheBase::SHARED_CACHE:
+         return sizeof(SharedCacheBlockInfo);
+
+      default:
+         LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+         return 0;
+   }
+}
+
 void
 CacheBlockInfo::invalidate()
 {
@@ -88,3 +130,19 @@ CacheBlockInfo::updateUsage(BitsUsedType used)
    m_used |= used;                     // Update usage mask
    return new_bits_set;
 }
+
+CacheBlockInfoArena::CacheBlockInfoArena(CacheBase::cache_t cache_type, UInt32 count)
+   : m_count(count)
+   , m_object_size(CacheBlockInfo::getSize(cache_type))
+{
+   m_storage = new char[m_count * m_object_size];
+   for (UInt32 i = 0; i < m_count; i++)
+      CacheBlockInfo::create(cache_type, get(i));
+}
+
+CacheBlockInfoArena::~CacheBlockInfoArena()
+{
+   for (UInt32 i = 0; i < m_count; i++)
+      get(i)->~CacheBlockInfo();
+   delete [] m_storage;
+}
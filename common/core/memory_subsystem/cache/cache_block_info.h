@@ -36,6 +36,9 @@ class CacheBlockInfo
       virtual ~CacheBlockInfo();
 
       static CacheBlockInfo* create(CacheBase::cache_t cache_type);
+      // Construct in place, buffer must hold at least getSize(cache_type) bytes
+      static CacheBlockInfo* create(CacheBase::cache_t cache_type, void *buffer);
+      static size_t getSize(CacheBase::cache_t cache_type);
 
       virtual void invalidate(void);
       virtual void clone(CacheBlockInfo* cache_block_info);
@@ -62,6 +65,21 @@ class CacheBlockInfo
       static const char* getOptionName(option_t option);
 };
 
+// Storage for a fixed number of CacheBlockInfo objects of one cache type, in a single allocation
+class CacheBlockInfoArena
+{
+   private:
+      const UInt32 m_count;
+      const size_t m_object_size;
+      char* m_storage;
+
+   public:
+      CacheBlockInfoArena(CacheBase::cache_t cache_type, UInt32 count);
+      ~CacheBlockInfoArena();
+
+      CacheBlockInfo* get(UInt32 index) const { return (CacheBlockInfo*)(m_storage + index * m_object_size); }
+};
+
 class CacheCntlr
 {
    public:
@@ -12,32 +12,46 @@
 #include "simulator.h"
 #include "config.h"
 #include "config.hpp"
+#include "fault_injection.h"
 
 CacheSet::CacheSet(CacheBase::cache_t cache_type,
       UInt32 associativity, UInt32 blocksize):
-      m_associativity(associativity), m_blocksize(blocksize)
+      m_own_block_infos(NULL), m_associativity(associativity), m_blocksize(blocksize)
 {
+   // Block infos are set up by initBlockInfos()
    m_cache_block_info_array = new CacheBlockInfo*[m_associativity];
-   for (UInt32 i = 0; i < m_associativity; i++)
-   {
-      m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type);
-   }
+   m_tags = new IntPtr[m_associativity];
 
+   // Data arrays come from the fault injection data arena: they start out zero, and only lines that are
+   // actually written to take up host memory. The arena owns the memory, it is released all at once.
    if (Sim()->getFaultinjectionManager())
-   {
-      m_blocks = new char[m_associativity * m_blocksize];
-      memset(m_blocks, 0x00, m_associativity * m_blocksize);
-   } else {
+      m_blocks = (char*)Sim()->getFaultinjectionManager()->getDataArena()->allocate(m_associativity * m_blocksize);
+   else
       m_blocks = NULL;
-   }
 }
 
 CacheSet::~CacheSet()
 {
-   for (UInt32 i = 0; i < m_associativity; i++)
-      delete m_cache_block_info_array[i];
+   if (m_own_block_infos)
+      delete m_own_block_infos;
    delete [] m_cache_block_info_array;
-   delete [] m_blocks;
+   delete [] m_tags;
+}
+
+void
+CacheSet::initBlockInfos(CacheBase::cache_t cache_type, CacheBlockInfoArena* arena, UInt32 arena_index)
+{
+   if (arena == NULL)
+   {
+      m_own_block_infos = arena = new CacheBlockInfoArena(cache_type, m_associativity);
+      arena_index = 0;
+   }
+
+   for (UInt32 i = 0; i < m_associativity; i++)
+   {
+      m_cache_block_info_array[i] = arena->get(arena_index + i);
+      m_tags[i] = m_cache_block_info_array[i]->getTag();
+   }
 }
 
 void
@@ -69,13 +83,24 @@ CacheSet::write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 byt
 CacheBlockInfo*
 CacheSet::find(IntPtr tag, UInt32* line_index)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
+   // Search from the highest way down, in groups of 64 ways
+   for (SInt32 first = (m_associativity - 1) & ~63; first >= 0; first -= 64)
    {
-      if (m_cache_block_info_array[index]->getTag() == tag)
+      UInt64 mask = matchTags(tag, first);
+      while (mask)
       {
-         if (line_index != NULL)
-            *line_index = index;
-         return (m_cache_block_info_array[index]);
+         UInt32 index = first + 63 - __builtin_clzll(mask);
+         mask &= ~(1ULL << (index - first));
+
+         if (m_cache_block_info_array[index]->getTag() == tag)
+         {
+            if (line_index != NULL)
+               *line_index = index;
+            return (m_cache_block_info_array[index]);
+         }
+         else
+            // Stale tag copy, block was invalidated through its CacheBlockInfo
+            m_tags[index] = m_cache_block_info_array[index]->getTag();
       }
    }
    return NULL;
@@ -84,13 +109,12 @@ CacheSet::find(IntPtr tag, UInt32* line_index)
 bool
 CacheSet::invalidate(IntPtr& tag)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
+   UInt32 index;
+   if (find(tag, &index))
    {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         m_cache_block_info_array[index]->invalidate();
-         return true;
-      }
+      m_cache_block_info_array[index]->invalidate();
+      m_tags[index] = m_cache_block_info_array[index]->getTag();
+      return true;
    }
    return false;
 }
@@ -120,6 +144,7 @@ CacheSet::insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* evicti
 
    // FIXME: This is a hack. I dont know if this is the best way to do
    m_cache_block_info_array[index]->clone(cache_block_info);
+   m_tags[index] = m_cache_block_info_array[index]->getTag();
 
    if (fill_buff != NULL && m_blocks != NULL)
       memcpy(&m_blocks[index * m_blocksize], (void*) fill_buff, m_blocksize);
@@ -135,36 +160,45 @@ CacheSet*
 CacheSet::createCacheSet(String cfgname, core_id_t core_id,
       String replacement_policy,
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info)
+      UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info, CacheBlockInfoArena* arena, UInt32 arena_index)
 {
    CacheBase::ReplacementPolicy policy = parsePolicyType(replacement_policy);
+   CacheSet* set = NULL;
    switch(policy)
    {
       case CacheBase::ROUND_ROBIN:
-         return new CacheSetRoundRobin(cache_type, associativity, blocksize);
+         set = new CacheSetRoundRobin(cache_type, associativity, blocksize);
+         break;
 
       case CacheBase::LRU:
       case CacheBase::LRU_QBS:
-         return new CacheSetLRU(cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         set = new CacheSetLRU(cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         break;
 
       case CacheBase::NRU:
-         return new CacheSetNRU(cache_type, associativity, blocksize);
+         set = new CacheSetNRU(cache_type, associativity, blocksize);
+         break;
 
       case CacheBase::MRU:
-         return new CacheSetMRU(cache_type, associativity, blocksize);
+         set = new CacheSetMRU(cache_type, associativity, blocksize);
+         break;
 
       case CacheBase::NMRU:
-         return new CacheSetNMRU(cache_type, associativity, blocksize);
+         set = new CacheSetNMRU(cache_type, associativity, blocksize);
+         break;
 
       case CacheBase::PLRU:
-         return new CacheSetPLRU(cache_type, associativity, blocksize);
+         set = new CacheSetPLRU(cache_type, associativity, blocksize);
+         break;
 
       case CacheBase::SRRIP:
       case CacheBase::SRRIP_QBS:
-         return new CacheSetSRRIP(cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         set = new CacheSetSRRIP(cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         break;
 
       case CacheBase::RANDOM:
-         return new CacheSetRandom(cache_type, associativity, blocksize);
+         set = new CacheSetRandom(cache_type, associativity, blocksize);
+         break;
 
       default:
          LOG_PRINT_ERROR("Unrecognized Cache Replacement Policy: %i",
@@ -172,7 +206,8 @@ CacheSet::createCacheSet(String cfgname, core_id_t core_id,
          break;
    }
 
-   return (CacheSet*) NULL;
+   set->initBlockInfos(cache_type, arena, arena_index);
+   return set;
 }
 
 CacheSetInfo*
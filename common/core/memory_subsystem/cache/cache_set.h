@@ -9,6 +9,10 @@
 #include "log.h"
 
 #include <cstring>
+#include <algorithm>
+#if defined(__x86_64__) && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+#endif
 
 // Per-cache object to store replacement-policy related info (e.g. statistics),
 // can collect data from all CacheSet* objects which are per set and implement the actual replacement policy
@@ -23,13 +27,19 @@ class CacheSet
 {
    public:
 
-      static CacheSet* createCacheSet(String cfgname, core_id_t core_id, String replacement_policy, CacheBase::cache_t cache_type, UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info = NULL);
+      // Block infos for the new set are taken from arena starting at arena_index, or allocated by the set itself if arena is NULL
+      static CacheSet* createCacheSet(String cfgname, core_id_t core_id, String replacement_policy, CacheBase::cache_t cache_type, UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info = NULL, CacheBlockInfoArena* arena = NULL, UInt32 arena_index = 0);
       static CacheSetInfo* createCacheSetInfo(String name, String cfgname, core_id_t core_id, String replacement_policy, UInt32 associativity);
       static CacheBase::ReplacementPolicy parsePolicyType(String policy);
       static UInt8 getNumQBSAttempts(CacheBase::ReplacementPolicy, String cfgname, core_id_t core_id);
 
    protected:
       CacheBlockInfo** m_cache_block_info_array;
+      CacheBlockInfoArena* m_own_block_infos;
+      // Copy of the tags of all ways, stored contiguously so a lookup only touches the CacheBlockInfo of the matching way.
+      // Invalid ways have tag ~0. A copy can be stale (still hold the old tag) when a block was invalidated through
+      // its CacheBlockInfo directly, find() and invalidate() verify candidates against the CacheBlockInfo and fix this up.
+      IntPtr* m_tags;
       char* m_blocks;
       UInt32 m_associativity;
       UInt32 m_blocksize;
@@ -41,6 +51,8 @@ class CacheSet
             UInt32 associativity, UInt32 blocksize);
       virtual ~CacheSet();
 
+      void initBlockInfos(CacheBase::cache_t cache_type, CacheBlockInfoArena* arena, UInt32 arena_index);
+
       UInt32 getBlockSize() { return m_blocksize; }
       UInt32 getAssociativity() { return m_associativity; }
       Lock& getLock() { return m_lock; }
@@ -60,6 +72,36 @@ class CacheSet
       virtual void updateReplacementIndex(UInt32) = 0;
 
       bool isValidReplacement(UInt32 index);
+
+   private:
+      // Bitmask of the ways in [first, first + 64) whose tag copy equals tag
+      UInt64 matchTags(IntPtr tag, UInt32 first) const
+      {
+         const UInt32 last = std::min(first + 64, m_associativity);
+         UInt64 mask = 0;
+         UInt32 way = first;
+#if defined(__x86_64__) && defined(__AVX2__)
+         const __m256i key = _mm256_set1_epi64x(tag);
+         for ( ; way + 4 <= last; way += 4)
+         {
+            __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)&m_tags[way]), key);
+            mask |= UInt64(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) << (way - first);
+         }
+#elif defined(__x86_64__) && defined(__SSE2__)
+         const __m128i key = _mm_set1_epi64x(tag);
+         for ( ; way + 2 <= last; way += 2)
+         {
+            // No 64-bit compare in SSE2: compare 32-bit halves, a 64-bit lane matches if both its halves do
+            __m128i eq32 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)&m_tags[way]), key);
+            __m128i eq = _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+            mask |= UInt64(_mm_movemask_pd(_mm_castsi128_pd(eq))) << (way - first);
+         }
+#endif
+         for ( ; way < last; ++way)
+            if (m_tags[way] == tag)
+               mask |= 1ULL << (way - first);
+         return mask;
+      }
 };
 
 #endif /* CACHE_SET_H */
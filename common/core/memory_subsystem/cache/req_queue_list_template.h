@@ -1,8 +1,5 @@
 #pragma once
 
-#include <map>
-#include <queue>
-
 #include "log.h"
 
 
@@ -12,14 +9,47 @@
 
 #ifndef ENABLE_CIRCULAR_QUEUE
 
+
+#include "flat_hash_map.h"
+
+// Per-address queues of outstanding requests, kept in a FlatHashMap indexed by address.
+// The oldest few requests of each address are stored inline in the map entry, so the common case
+// (one or two requests per address) does not allocate. Longer queues continue in a list of nodes,
+// which are recycled through a free list rather than returned to the heap.
 template <class T_Req> class ReqQueueListTemplate
 {
    private:
-      std::map<IntPtr, std::queue<T_Req*>* > m_req_queue_list;
+      static const UInt32 INLINE_SIZE = 4;
+
+      struct Node
+      {
+         T_Req* req;
+         Node* next;
+      };
+
+      struct Queue
+      {
+         T_Req* reqs[INLINE_SIZE]; // Oldest requests, circular starting at first
+         UInt32 first;
+         UInt32 size;              // Total number of requests, including those in the overflow list
+         Node* overflow_head;      // Requests after the inline ones, oldest first
+         Node* overflow_tail;
+      };
+
+      FlatHashMap<IntPtr, Queue> m_req_queue_list;
+      Node* m_free_nodes;
+
+      Queue* getQueue(IntPtr address)
+      {
+         Queue* queue = m_req_queue_list.find(address);
+         LOG_ASSERT_ERROR(queue != NULL,
+               "Could not find a request with address(0x%x)", address);
+         return queue;
+      }
 
    public:
-      ReqQueueListTemplate() {};
-      ~ReqQueueListTemplate() {};
+      ReqQueueListTemplate() : m_free_nodes(NULL) {};
+      ~ReqQueueListTemplate();
 
       void enqueue(IntPtr address, T_Req* shmem_req);
       T_Req* dequeue(IntPtr address);
@@ -29,31 +59,75 @@ template <class T_Req> class ReqQueueListTemplate
       bool empty(IntPtr address);
 };
 
+template <class T_Req>
+ReqQueueListTemplate<T_Req>::~ReqQueueListTemplate()
+{
+   for(typename FlatHashMap<IntPtr, Queue>::iterator it = m_req_queue_list.begin(); it != m_req_queue_list.end(); ++it)
+   {
+      while (Node* node = it->second.overflow_head)
+      {
+         it->second.overflow_head = node->next;
+         delete node;
+      }
+   }
+   while (Node* node = m_free_nodes)
+   {
+      m_free_nodes = node->next;
+      delete node;
+   }
+}
+
 template <class T_Req>
 void
 ReqQueueListTemplate<T_Req>::enqueue(IntPtr address, T_Req* shmem_req)
 {
-   if (m_req_queue_list.count(address) == 0)
+   Queue& queue = m_req_queue_list[address];
+   if (queue.size < INLINE_SIZE)
+   {
+      queue.reqs[(queue.first + queue.size) % INLINE_SIZE] = shmem_req;
+   }
+   else
    {
-      m_req_queue_list[address] = new std::queue<T_Req*>();
+      Node* node = m_free_nodes;
+      if (node)
+         m_free_nodes = node->next;
+      else
+         node = new Node();
+      node->req = shmem_req;
+      node->next = NULL;
+      if (queue.overflow_tail)
+         queue.overflow_tail->next = node;
+      else
+         queue.overflow_head = node;
+      queue.overflow_tail = node;
    }
-   m_req_queue_list[address]->push(shmem_req);
+   ++queue.size;
 }
 
 template <class T_Req>
 T_Req*
 ReqQueueListTemplate<T_Req>::dequeue(IntPtr address)
 {
-   LOG_ASSERT_ERROR(m_req_queue_list.count(address) != 0,
-         "Could not find a request with address(0x%x)", address);
+   Queue* queue = getQueue(address);
 
-   T_Req* shmem_req = m_req_queue_list[address]->front();
-   m_req_queue_list[address]->pop();
-   if (m_req_queue_list[address]->empty())
+   T_Req* shmem_req = queue->reqs[queue->first];
+   if (--queue->size == 0)
    {
-      delete m_req_queue_list[address];
       m_req_queue_list.erase(address);
+      return shmem_req;
    }
+
+   if (Node* node = queue->overflow_head)
+   {
+      // Oldest overflow request takes the freed inline slot, which is the last one after advancing first
+      queue->reqs[queue->first] = node->req;
+      queue->overflow_head = node->next;
+      if (queue->overflow_head == NULL)
+         queue->overflow_tail = NULL;
+      node->next = m_free_nodes;
+      m_free_nodes = node;
+   }
+   queue->first = (queue->first + 1) % INLINE_SIZE;
    return shmem_req;
 }
 
@@ -61,46 +135,42 @@ template <class T_Req>
 T_Req*
 ReqQueueListTemplate<T_Req>::front(IntPtr address)
 {
-   LOG_ASSERT_ERROR(m_req_queue_list.count(address) != 0,
-         "Could not find a request with address(0x%x)", address);
-
-   return m_req_queue_list[address]->front();
+   Queue* queue = getQueue(address);
+   return queue->reqs[queue->first];
 }
 
 template <class T_Req>
 T_Req*
 ReqQueueListTemplate<T_Req>::back(IntPtr address)
 {
-   LOG_ASSERT_ERROR(m_req_queue_list.count(address) != 0,
-         "Could not find a request with address(0x%x)", address);
-
-   return m_req_queue_list[address]->back();
+   Queue* queue = getQueue(address);
+   if (queue->overflow_tail)
+      return queue->overflow_tail->req;
+   else
+      return queue->reqs[(queue->first + queue->size - 1) % INLINE_SIZE];
 }
 
 template <class T_Req>
 UInt32
 ReqQueueListTemplate<T_Req>::size(IntPtr address)
 {
-   if (m_req_queue_list.count(address) == 0)
-      return 0;
-   else
-      return m_req_queue_list[address]->size();
+   Queue* queue = m_req_queue_list.find(address);
+   return queue ? queue->size : 0;
 }
 
 template <class T_Req>
 bool
 ReqQueueListTemplate<T_Req>::empty(IntPtr address)
 {
-   if (m_req_queue_list.count(address) == 0)
-      return true;
-   else
-      return false;
+   return m_req_queue_list.find(address) == NULL;
 }
 
 
 #else // ENABLE_CIRCULAR_QUEUE
 
 
+#include <map>
+
 #include "circular_queue.h"
 
 template <class T_Req> class ReqQueueListTemplate
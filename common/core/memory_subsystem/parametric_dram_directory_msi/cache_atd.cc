@@ -98,10 +98,9 @@ void ATD::access(Core::mem_op_t mem_op_type, bool cache_hit, IntPtr address)
       }
       else
       {
-         PrL1CacheBlockInfo* cache_block_info = new PrL1CacheBlockInfo(tag, CacheState::MODIFIED);
+         PrL1CacheBlockInfo cache_block_info(tag, CacheState::MODIFIED);
          bool eviction; PrL1CacheBlockInfo evict_block_info;
-         m_sets[set_index]->insert(cache_block_info, NULL, &eviction, &evict_block_info, NULL);
-         delete cache_block_info;
+         m_sets[set_index]->insert(&cache_block_info, NULL, &eviction, &evict_block_info, NULL);
       }
 
       if (mem_op_type == Core::WRITE)
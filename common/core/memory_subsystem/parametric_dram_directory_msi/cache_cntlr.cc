@@ -1761,6 +1761,12 @@ CacheCntlr::handleMsgFromDramDirectory(
       CacheDirectoryWaiter* request = m_master->m_directory_waiters.front(address);
       requester = request->cache_cntlr->m_core_id;
    }
+   else if (shmem_msg->getRequester() != m_core_id)
+   {
+      // Invalidation, flush or writeback on behalf of another core: coherence traffic between cores, used to adapt the barrier quantum.
+      // This includes directory evictions, which carry the core whose miss needed the directory entry as requester
+      Sim()->getClockSkewMinimizationServer()->notifyInteraction();
+   }
 
    acquireStackLock(address);
 MYLOG("begin");
@@ -19,6 +19,8 @@
 
 #include "boost/tuple/tuple.hpp"
 
+#include <deque>
+
 class DramCntlrInterface;
 class ATD;
 
@@ -28,6 +28,16 @@
 namespace ParametricDramDirectoryMSI
 {
 
+// Serializes a ShmemMsg and its data straight into each transport buffer
+class ShmemMsgWriter : public NetPacketWriter
+{
+   public:
+      ShmemMsgWriter(PrL1PrL2DramDirectoryMSI::ShmemMsg *shmem_msg) : m_shmem_msg(shmem_msg) {}
+      void write(Byte *data) const { m_shmem_msg->makeMsgBuf(data); }
+   private:
+      PrL1PrL2DramDirectoryMSI::ShmemMsg *m_shmem_msg;
+};
+
 std::map<CoreComponentType, CacheCntlr*> MemoryManager::m_all_cache_cntlrs;
 
 MemoryManager::MemoryManager(Core* core,
@@ -522,16 +532,7 @@ MYLOG("begin");
          break;
    }
 
-   // Delete the allocated Shared Memory Message
-   // First delete 'data_buf' if it is present
-   // LOG_PRINT("Finished handling Shmem Msg");
-
-   if (shmem_msg->getDataLength() > 0)
-   {
-      assert(shmem_msg->getDataBuf());
-      delete [] shmem_msg->getDataBuf();
-   }
-   delete shmem_msg;
+   // shmem_msg lives in the packet's buffer, which is freed by the network once we return
 MYLOG("end");
 }
 
@@ -543,7 +544,6 @@ MYLOG("send msg %u %ul%u > %ul%u", msg_type, requester, sender_mem_component, re
    PrL1PrL2DramDirectoryMSI::ShmemMsg shmem_msg(msg_type, sender_mem_component, receiver_mem_component, requester, address, data_buf, data_length, perf);
    shmem_msg.setWhere(where);
 
-   Byte* msg_buf = shmem_msg.makeMsgBuf();
    SubsecondTime msg_time = getShmemPerfModel()->getElapsedTime(thread_num);
    perf->updateTime(msg_time);
 
@@ -552,13 +552,12 @@ MYLOG("send msg %u %ul%u > %ul%u", msg_type, requester, sender_mem_component, re
       LOG_PRINT("Sending Msg: type(%u), address(0x%x), sender_mem_component(%u), receiver_mem_component(%u), requester(%i), sender(%i), receiver(%i)", msg_type, address, sender_mem_component, receiver_mem_component, requester, getCore()->getId(), receiver);
    }
 
+   // The network models only look at the ShmemMsg itself, the data is added when serializing into the transport buffers
    NetPacket packet(msg_time, SHARED_MEM_1,
          m_core_id_master, receiver,
-         shmem_msg.getMsgLen(), (const void*) msg_buf);
-   getNetwork()->netSend(packet);
-
-   // Delete the Msg Buf
-   delete [] msg_buf;
+         shmem_msg.getMsgLen(), (const void*) &shmem_msg);
+   ShmemMsgWriter writer(&shmem_msg);
+   getNetwork()->netSend(packet, &writer);
 }
 
 void
@@ -568,7 +567,6 @@ MYLOG("bcast msg");
    assert((data_buf == NULL) == (data_length == 0));
    PrL1PrL2DramDirectoryMSI::ShmemMsg shmem_msg(msg_type, sender_mem_component, receiver_mem_component, requester, address, data_buf, data_length, perf);
 
-   Byte* msg_buf = shmem_msg.makeMsgBuf();
    SubsecondTime msg_time = getShmemPerfModel()->getElapsedTime(thread_num);
    perf->updateTime(msg_time);
 
@@ -577,13 +575,12 @@ MYLOG("bcast msg");
       LOG_PRINT("Sending Msg: type(%u), address(0x%x), sender_mem_component(%u), receiver_mem_component(%u), requester(%i), sender(%i), receiver(%i)", msg_type, address, sender_mem_component, receiver_mem_component, requester, getCore()->getId(), NetPacket::BROADCAST);
    }
 
+   // The network models only look at the ShmemMsg itself, the data is added when serializing into the transport buffers
    NetPacket packet(msg_time, SHARED_MEM_1,
          m_core_id_master, NetPacket::BROADCAST,
-         shmem_msg.getMsgLen(), (const void*) msg_buf);
-   getNetwork()->netSend(packet);
-
-   // Delete the Msg Buf
-   delete [] msg_buf;
+         shmem_msg.getMsgLen(), (const void*) &shmem_msg);
+   ShmemMsgWriter writer(&shmem_msg);
+   getNetwork()->netSend(packet, &writer);
 }
 
 void
@@ -35,6 +35,14 @@ DramCntlr::DramCntlr(MemoryManagerBase* memory_manager,
       ? Sim()->getFaultinjectionManager()->getFaultInjector(memory_manager->getCore()->getId(), MemComponent::DRAM)
       : NULL;
 
+   if (Sim()->getFaultinjectionManager())
+   {
+      LOG_ASSERT_ERROR(PagedDataStore::PAGE_BYTES % cache_block_size == 0, "Cache block size %u does not divide the data store page size", cache_block_size);
+      m_data_store = new PagedDataStore(Sim()->getFaultinjectionManager()->getDataArena());
+   }
+   else
+      m_data_store = NULL;
+
    m_dram_access_count = new AccessCountMap[DramCntlrInterface::NUM_ACCESS_TYPES];
    registerStatsMetric("dram", memory_manager->getCore()->getId(), "reads", &m_reads);
    registerStatsMetric("dram", memory_manager->getCore()->getId(), "writes", &m_writes);
@@ -46,24 +54,23 @@ DramCntlr::~DramCntlr()
    delete [] m_dram_access_count;
 
    delete m_dram_perf_model;
+   // Pages are owned by the data arena
+   delete m_data_store;
 }
 
 boost::tuple<SubsecondTime, HitWhere::where_t>
 DramCntlr::getDataFromDram(IntPtr address, core_id_t requester, Byte* data_buf, SubsecondTime now, ShmemPerf *perf)
 {
-   if (Sim()->getFaultinjectionManager())
+   if (m_data_store)
    {
-      if (m_data_map.count(address) == 0)
-      {
-         m_data_map[address] = new Byte[getCacheBlockSize()];
-         memset((void*) m_data_map[address], 0x00, getCacheBlockSize());
-      }
+      // Lines that were never written to read as zero
+      Byte *data = m_data_store->getData(address);
 
       // NOTE: assumes error occurs in memory. If we want to model bus errors, insert the error into data_buf instead
       if (m_fault_injector)
-         m_fault_injector->preRead(address, address, getCacheBlockSize(), (Byte*)m_data_map[address], now);
+         m_fault_injector->preRead(address, address, getCacheBlockSize(), data, now);
 
-      memcpy((void*) data_buf, (void*) m_data_map[address], getCacheBlockSize());
+      memcpy((void*) data_buf, (void*) data, getCacheBlockSize());
    }
 
    SubsecondTime dram_access_latency = runDramPerfModel(requester, now, address, READ, perf);
@@ -80,17 +87,14 @@ DramCntlr::getDataFromDram(IntPtr address, core_id_t requester, Byte* data_buf,
 boost::tuple<SubsecondTime, HitWhere::where_t>
 DramCntlr::putDataToDram(IntPtr address, core_id_t requester, Byte* data_buf, SubsecondTime now)
 {
-   if (Sim()->getFaultinjectionManager())
+   if (m_data_store)
    {
-      if (m_data_map[address] == NULL)
-      {
-         LOG_PRINT_ERROR("Data Buffer does not exist");
-      }
-      memcpy((void*) m_data_map[address], (void*) data_buf, getCacheBlockSize());
+      Byte *data = m_data_store->getData(address);
+      memcpy((void*) data, (void*) data_buf, getCacheBlockSize());
 
       // NOTE: assumes error occurs in memory. If we want to model bus errors, insert the error into data_buf instead
       if (m_fault_injector)
-         m_fault_injector->postWrite(address, address, getCacheBlockSize(), (Byte*)m_data_map[address], now);
+         m_fault_injector->postWrite(address, address, getCacheBlockSize(), data, now);
    }
 
    SubsecondTime dram_access_latency = runDramPerfModel(requester, now, address, WRITE, NULL);
@@ -11,6 +11,7 @@
 #include "memory_manager_base.h"
 #include "dram_cntlr_interface.h"
 #include "subsecond_time.h"
+#include "paged_data_store.h"
 
 class FaultInjector;
 
@@ -19,7 +20,7 @@ namespace PrL1PrL2DramDirectoryMSI
    class DramCntlr : public DramCntlrInterface
    {
       private:
-         std::unordered_map<IntPtr, Byte*> m_data_map;
+         PagedDataStore* m_data_store;
          DramPerfModel* m_dram_perf_model;
          FaultInjector* m_fault_injector;
 
@@ -65,8 +65,10 @@ namespace PrL1PrL2DramDirectoryMSI
 
          ~ShmemMsg();
 
+         // Message stored in msg_buf (no copy is made), it is valid as long as msg_buf is
          static ShmemMsg* getShmemMsg(Byte* msg_buf);
-         Byte* makeMsgBuf();
+         // Serialize into msg_buf, which holds getMsgLen() bytes
+         void makeMsgBuf(Byte* msg_buf);
          UInt32 getMsgLen();
 
          // Modeling
@@ -0,0 +1,227 @@
+#include "approx_table.h"
+#include "stats.h"
+#include "thread_manager.h"
+
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+
+ApproxTable::ApproxTable(UInt32 num_cores)
+   : m_num_cores(num_cores)
+   , m_version(0)
+   , m_last_entry(NULL)
+{
+   m_totals = allocateCounters();
+
+   for(UInt32 i = 0; i < m_num_cores; ++i)
+   {
+      registerStatsMetric("amhm", i, "l2-reads", &m_totals[i].numberOfReads);
+      registerStatsMetric("amhm", i, "l2-writes", &m_totals[i].numberOfWrites);
+      registerStatsMetric("amhm", i, "injected-faults", &m_totals[i].numberOfInjectedFaults);
+   }
+}
+
+ApproxTable::~ApproxTable()
+{
+   for(std::deque<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      free(it->counters);
+   free(m_totals);
+}
+
+ApproxTable::Counters*
+ApproxTable::allocateCounters()
+{
+   Counters *counters;
+   __attribute__((unused)) int rc = posix_memalign((void**)&counters, 64, m_num_cores * sizeof(Counters)); // Align by cache line size so shards of different cores never share a line
+   LOG_ASSERT_ERROR (rc == 0, "posix_memalign failed to allocate memory");
+   memset(counters, 0, m_num_cores * sizeof(Counters));
+   return counters;
+}
+
+ApproxTable::Entry*
+ApproxTable::add(IntPtr start_address, IntPtr end_address)
+{
+   Entry *entry = insertEntry(start_address, end_address);
+
+   if (entry)
+   {
+      // Per-range statistics, indexed by range id.
+      // Called from the application thread: hold the thread manager lock, as do other run-time registrations, so statistics are not written while we add to them
+      ScopedLock sl(Sim()->getThreadManager()->getLock());
+      Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("amhm-range", entry->id, "start-address", getEntryStat, (UInt64)entry));
+      Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("amhm-range", entry->id, "reads", getEntryStat, (UInt64)entry));
+      Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("amhm-range", entry->id, "writes", getEntryStat, (UInt64)entry));
+      Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("amhm-range", entry->id, "injected-faults", getEntryStat, (UInt64)entry));
+   }
+
+   return entry;
+}
+
+ApproxTable::Entry*
+ApproxTable::insertEntry(IntPtr start_address, IntPtr end_address)
+{
+   ScopedLock sl(m_lock);
+
+   start_address = alignStart(start_address);
+   end_address = alignEnd(end_address);
+
+   if (start_address <= end_address)
+   {
+      // Reject ranges that overlap with the closest live range on either side
+      Index::iterator next = m_index.lower_bound(start_address);
+      if (next != m_index.end() && next->second->start_address <= end_address)
+         return NULL;
+      if (next != m_index.begin())
+      {
+         Index::iterator prev = next; --prev;
+         if (prev->second->end_address >= start_address)
+            return NULL;
+      }
+   }
+
+   Entry entry;
+   entry.id = m_entries.size();
+   entry.start_address = start_address;
+   entry.end_address = end_address;
+   entry.quality_level = 0;
+   entry.counters = allocateCounters();
+   m_entries.push_back(entry);
+   m_last_entry = &m_entries.back();
+
+   // Ranges smaller than a cache block end up empty after alignment, they can never match
+   if (start_address <= end_address)
+      m_index[start_address] = m_last_entry;
+
+   __sync_fetch_and_add(&m_version, 1);
+
+   return m_last_entry;
+}
+
+ApproxTable::Entry*
+ApproxTable::setQuality(double quality_level)
+{
+   ScopedLock sl(m_lock);
+
+   if (m_last_entry)
+      m_last_entry->quality_level = quality_level;
+
+   return m_last_entry;
+}
+
+ApproxTable::Entry*
+ApproxTable::remove(IntPtr start_address)
+{
+   ScopedLock sl(m_lock);
+
+   Index::iterator it = m_index.find(alignStart(start_address));
+   if (it == m_index.end())
+      return NULL;
+
+   Entry *entry = it->second;
+   entry->quality_level = 0;
+   m_index.erase(it);
+
+   __sync_fetch_and_add(&m_version, 1);
+
+   return entry;
+}
+
+ApproxTable::Entry*
+ApproxTable::find(IntPtr address)
+{
+   ScopedReadLock sl(m_lock);
+
+   IntPtr low, high;
+   return lookup(address, low, high);
+}
+
+ApproxTable::Entry*
+ApproxTable::findSlow(IntPtr address, LookupCache &cache)
+{
+   ScopedReadLock sl(m_lock);
+
+   // Read the version while holding the lock, so it matches the index state we'll cache
+   cache.m_version = m_version;
+   cache.m_entry = lookup(address, cache.m_low, cache.m_high);
+
+   return cache.m_entry;
+}
+
+ApproxTable::Entry*
+ApproxTable::lookup(IntPtr address, IntPtr &low, IntPtr &high)
+{
+   // Find the last range starting at or before address
+   Index::iterator next = m_index.upper_bound(address);
+   if (next != m_index.begin())
+   {
+      Index::iterator prev = next; --prev;
+      if (address <= prev->second->end_address)
+      {
+         low = prev->second->start_address;
+         high = prev->second->end_address;
+         return prev->second;
+      }
+      low = prev->second->end_address + 1;
+   }
+   else
+      low = 0;
+
+   // Not found, return the gap between the neighbouring ranges
+   high = next == m_index.end() ? ~IntPtr(0) : next->second->start_address - 1;
+   return NULL;
+}
+
+ApproxTable::Counters
+ApproxTable::sumCounters(Counters *counters)
+{
+   Counters sum;
+   memset(&sum, 0, sizeof(sum));
+   for(UInt32 i = 0; i < m_num_cores; ++i)
+   {
+      sum.numberOfReads += counters[i].numberOfReads;
+      sum.numberOfWrites += counters[i].numberOfWrites;
+      sum.numberOfInjectedFaults += counters[i].numberOfInjectedFaults;
+   }
+   return sum;
+}
+
+UInt64
+ApproxTable::getEntryStat(String objectName, UInt32 index, String metricName, UInt64 arg)
+{
+   Entry *entry = (Entry *)arg;
+
+   if (metricName == "start-address")
+      return entry->start_address;
+
+   Counters sum = Sim()->getApproxTable()->getCounters(entry);
+   if (metricName == "reads")
+      return sum.numberOfReads;
+   else if (metricName == "writes")
+      return sum.numberOfWrites;
+   else
+      return sum.numberOfInjectedFaults;
+}
+
+void
+ApproxTable::saveStats(String filename)
+{
+   std::ofstream outfile(filename.c_str());
+   if (!outfile)
+      return;
+
+   outfile << "Entry\t\t\t\tStart Address\t\t\tNumber of Reads\t\t\tNumber of Writes\t\t\tNumber of Injected Faults\n";
+   for(std::deque<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+   {
+      Counters sum = getCounters(&*it);
+      outfile << it->id << std::setw(12) << "\t\t\t0x" << std::hex << std::setw(12) << it->start_address
+              << "\t\t\t" << std::dec << std::setw(12) << sum.numberOfReads << "\t\t\t" << std::setw(12)
+              << sum.numberOfWrites << "\t\t\t"
+              << std::setw(12) << sum.numberOfInjectedFaults << "\n";
+   }
+
+   Counters totals = getTotals();
+   outfile << "\n--------------------------------------------------------------------\n";
+   outfile << "Total number of reads in L2 cache = " << totals.numberOfReads << "\n";
+   outfile << "Total number of writes in L2 cache = " << totals.numberOfWrites << "\n";
+}
@@ -0,0 +1,130 @@
+#ifndef __APPROX_TABLE_H
+#define __APPROX_TABLE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+#include <map>
+#include <deque>
+
+// AMHM approximation table: the set of address ranges registered through AMHM_approx/AMHM_qual,
+// each with the bit error rate (quality level) to inject into L2 writes to that range.
+//
+// Live ranges are kept in an interval index keyed on start address (ranges never overlap),
+// so a lookup is O(log n) regardless of how many ranges were registered. Entries are never
+// freed while the simulation runs: their counters are reported at the end, and Entry pointers
+// handed out to the fault injectors stay valid.
+//
+// Access counters are sharded per core: each core's L2 fault injector only updates its own
+// shard, shards are summed when statistics are written.
+class ApproxTable
+{
+   public:
+      struct Counters
+      {
+         UInt64 numberOfReads;
+         UInt64 numberOfWrites;
+         UInt64 numberOfInjectedFaults;
+         char padding[64 - 3 * sizeof(UInt64)]; // Keep shards of different cores on different cache lines (arrays are allocated 64-byte aligned)
+      };
+
+      struct Entry
+      {
+         UInt32 id;
+         IntPtr start_address;
+         IntPtr end_address;
+         double quality_level;
+         Counters *counters;                 // One shard per core
+      };
+
+      // One-entry lookup cache, owned by each caller (one per fault injector, and hence per core).
+      // Remembers the last range that was hit, or the gap between ranges that was missed,
+      // and is valid as long as the table has not been modified since.
+      class LookupCache
+      {
+         friend class ApproxTable;
+         public:
+            LookupCache() : m_version(~0UL), m_low(1), m_high(0), m_entry(NULL) {}
+         private:
+            UInt64 m_version;
+            IntPtr m_low, m_high;
+            Entry *m_entry;
+      };
+
+      ApproxTable(UInt32 num_cores);
+      ~ApproxTable();
+
+      // Register range [start_address, end_address], returns NULL if it overlaps an existing approximate range
+      Entry* add(IntPtr start_address, IntPtr end_address);
+      // Set the quality level of the most recently added range
+      Entry* setQuality(double quality_level);
+      // Make the range starting at start_address accurate again, returns NULL if no such range exists
+      Entry* remove(IntPtr start_address);
+
+      // Find the approximate range containing address, or NULL
+      Entry* find(IntPtr address);
+      Entry* find(IntPtr address, LookupCache &cache)
+      {
+         if (cache.m_version == m_version && address >= cache.m_low && address <= cache.m_high)
+            return cache.m_entry;
+         else
+            return findSlow(address, cache);
+      }
+
+      Entry* getLastEntry() { return m_last_entry; }
+      UInt32 getNumEntries() { return m_entries.size(); }
+      Entry* getEntry(UInt32 id) { return &m_entries[id]; }
+
+      // Update the counters of core_id, entry can be NULL for accesses outside of any approximate range
+      void recordRead(core_id_t core_id, Entry *entry)
+      {
+         ++m_totals[core_id].numberOfReads;
+         if (entry)
+            ++entry->counters[core_id].numberOfReads;
+      }
+      void recordWrite(core_id_t core_id, Entry *entry)
+      {
+         ++m_totals[core_id].numberOfWrites;
+         if (entry)
+            ++entry->counters[core_id].numberOfWrites;
+      }
+      void recordInjectedFault(core_id_t core_id, Entry *entry)
+      {
+         ++m_totals[core_id].numberOfInjectedFaults;
+         if (entry)
+            ++entry->counters[core_id].numberOfInjectedFaults;
+      }
+
+      // Sum of all per-core shards
+      Counters getCounters(Entry *entry) { return sumCounters(entry->counters); }
+      Counters getTotals() { return sumCounters(m_totals); }
+
+      // Write a per-range summary to filename
+      void saveStats(String filename);
+
+      // Start addresses are moved past the allocator header and aligned to the 64-byte cache block size
+      static IntPtr alignStart(IntPtr address) { return (address + 0xD0) & 0xFFFFFFFFFFC0; }
+      static IntPtr alignEnd(IntPtr address) { return address & 0xFFFFFFFFFFC0; }
+
+   private:
+      typedef std::map<IntPtr, Entry*> Index;
+
+      Entry* insertEntry(IntPtr start_address, IntPtr end_address);
+      Entry* findSlow(IntPtr address, LookupCache &cache);
+      Entry* lookup(IntPtr address, IntPtr &low, IntPtr &high);
+      Counters sumCounters(Counters *counters);
+      Counters* allocateCounters();
+
+      static UInt64 getEntryStat(String objectName, UInt32 index, String metricName, UInt64 arg);
+
+      const UInt32 m_num_cores;
+
+      RwLock m_lock;
+      volatile UInt64 m_version;          // Incremented on every change to the index, invalidates all LookupCaches
+      std::deque<Entry> m_entries;        // All entries ever registered, indexed by id (deque: push_back keeps pointers valid)
+      Index m_index;                      // Approximate (live) ranges, keyed on start address
+      Entry *m_last_entry;
+      Counters *m_totals;                 // Per-core counters of all L2 accesses
+};
+
+#endif // __APPROX_TABLE_H
@@ -3,6 +3,7 @@
 
 #include "fixed_types.h"
 #include "core.h"
+#include "paged_data_store.h"
 
 class FaultInjector;
 
@@ -22,11 +23,16 @@ class FaultinjectionManager
       };
       fault_injector_t m_injector;
 
+      DataArena m_data_arena;
+
    public:
       static FaultinjectionManager* create();
 
       FaultinjectionManager(fault_type_t type, fault_injector_t injector);
 
+      // Backing memory for the data arrays of caches and DRAM
+      DataArena* getDataArena() { return &m_data_arena; }
+
       FaultInjector* getFaultInjector(UInt32 core_id, MemComponent::component_t mem_component);
 
       void applyFault(Core *core, IntPtr read_address, UInt32 data_size, MemoryResult &memres, Byte *data, const Byte *fault);
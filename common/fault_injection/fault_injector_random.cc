@@ -1,15 +1,42 @@
 #include "fault_injector_random.h"
 #include "rng.h"
 #include "simulator.h"
+#include "config.hpp"
+#include "log.h"
+
+#include <cmath>
 
 FaultInjectorRandom::FaultInjectorRandom(UInt32 core_id, MemComponent::component_t mem_component)
    : FaultInjector(core_id, mem_component)
-   , m_rng(rng_seed(0))
 {
    if (mem_component == MemComponent::L2_CACHE)
       m_active = true;
    else
       m_active = false;
+
+   String sampling = Sim()->getCfg()->getString("fault_injection/random/sampling");
+   if (sampling == "bit")
+      m_geometric = false;
+   else if (sampling == "geometric")
+      m_geometric = true;
+   else
+      LOG_PRINT_ERROR("Unknown fault_injection/random/sampling value %s", sampling.c_str());
+
+   // Give each injector its own reproducible stream
+   UInt64 seed = Sim()->getCfg()->getInt("fault_injection/random/seed");
+   m_rng = rng_seed((seed * Sim()->getConfig()->getTotalCores() + core_id) * (MemComponent::MAX_MEM_COMPONENT + 1) + mem_component);
+}
+
+UInt32
+FaultInjectorRandom::nextFaultDistance(double error_rate)
+{
+   // Number of correct bits before the next faulty one: geometrically distributed with p = error_rate,
+   // sampled by inversion from a uniform number in (0, 1]
+   if (error_rate >= 1)
+      return 0;
+   double uniform = (rng_next(m_rng) + 1.) / 4294967296.;
+   double distance = floor(log(uniform) / log1p(-error_rate));
+   return distance < UINT32_MAX ? distance : UINT32_MAX;
 }
 
 void
@@ -23,10 +50,8 @@ FaultInjectorRandom::preRead(IntPtr addr, IntPtr location, UInt32 data_size, Byt
 //       }
     if (m_active)
     {
-        Sim()->numberOfL2Read++;
-        signed int entry = Sim()->approx_table_search(addr);
-        if(entry != -1)
-               Sim()->approx_table[entry].numberOfReads++;
+        ApproxTable::Entry *entry = Sim()->getApproxTable()->find(addr, m_approx_cache);
+        Sim()->getApproxTable()->recordRead(m_core_id, entry);
     }
     
 }
@@ -40,17 +65,30 @@ FaultInjectorRandom::postWrite(IntPtr addr, IntPtr location, UInt32 data_size, B
    if (m_active)
    {
        double random_number = 0;
-       signed int entry = Sim()->approx_table_search(addr);
-       Sim()->numberOfL2Write++;
-       if(entry != -1)
-           Sim()->approx_table[entry].numberOfWrites++;
-        //printf("error rate is %f\n",Sim()->get_error_rate(addr));
+       ApproxTable::Entry *entry = Sim()->getApproxTable()->find(addr, m_approx_cache);
+       Sim()->getApproxTable()->recordWrite(m_core_id, entry);
+       double error_rate = entry ? entry->quality_level : 0;
+        //printf("error rate is %f\n",error_rate);
+        if (m_geometric) {
+            // Jump straight from one faulty bit to the next, cost scales with the number of faults
+            if (error_rate <= 0)
+                return;
+            UInt32 num_bits = data_size * 8;
+            for(UInt32 i = nextFaultDistance(error_rate); i < num_bits;) {
+                Sim()->getApproxTable()->recordInjectedFault(m_core_id, entry);
+                fault[i / 8] |= 1 << (i % 8);
+                UInt32 distance = nextFaultDistance(error_rate);
+                if (distance >= num_bits - i - 1)
+                    break;
+                i += distance + 1;
+            }
+            return;
+        }
         for(UInt32 i = 0; i < data_size * 8; i++) {
             random_number = (double) rand() / RAND_MAX;
-            if(random_number < Sim()->get_error_rate(addr)) {
-                //printf("Man Injam FI, random number= %e Error rate= %e.\n", random_number, Sim()->get_error_rate(addr));
-                if(entry != -1)
-                    Sim()->approx_table[entry].numberOfInjectedFaults++;
+            if(random_number < error_rate) {
+                //printf("Man Injam FI, random number= %e Error rate= %e.\n", random_number, error_rate);
+                Sim()->getApproxTable()->recordInjectedFault(m_core_id, entry);
                 fault[i / 8] |= 1 << (i % 8);
 //                    printf("Inserting bit %d flip at address %" PRIxPTR " on read access by core %d to component %s\n",
 //                    i, addr, m_core_id, MemComponentString(m_mem_component));
@@ -2,6 +2,7 @@
 #define __FAULT_INJECTOR_RANDOM_H
 
 #include "fault_injection.h"
+#include "approx_table.h"
 
 class FaultInjectorRandom : public FaultInjector
 {
@@ -13,7 +14,11 @@ class FaultInjectorRandom : public FaultInjector
 
    private:
       bool m_active;
+      bool m_geometric;
       UInt64 m_rng;
+      ApproxTable::LookupCache m_approx_cache;
+
+      UInt32 nextFaultDistance(double error_rate);
 };
 
 #endif // __FAULT_INJECTION_RANDOM_H
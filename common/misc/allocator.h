@@ -6,12 +6,13 @@
 
 #include <typeinfo>
 #include <cxxabi.h>
+#include <vector>
 
 // Pool allocator
 
 class Allocator
 {
-   private:
+   protected:
       struct DataElement
       {
           Allocator *allocator;
@@ -73,4 +74,85 @@ template <typename T, unsigned MaxItems = 0> class TypedAllocator : public Alloc
       }
 };
 
+// Pool allocator for items of ElemSize bytes that are allocated by a single thread at a time (the owner),
+// but can be freed by any thread (e.g. DynamicInstructions, created by the front end and freed by the core model).
+// The owner allocates from a private free list without any synchronization. Frees are pushed onto a lock-free
+// stack, which the owner takes over in a single atomic exchange once its private list runs empty.
+// Items are never popped individually from the shared stack, so there is no ABA problem.
+
+template <size_t ElemSize, unsigned ChunkItems = 1024> class SingleOwnerAllocator : public Allocator
+{
+   private:
+      struct FreeElement
+      {
+         Allocator *allocator;
+         FreeElement *next;
+      };
+      static const size_t STRIDE = (sizeof(DataElement) + ElemSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+      static_assert(ElemSize >= sizeof(FreeElement*), "Free items are linked through their first word");
+
+      // Owner side
+      FreeElement *m_free;
+      std::vector<char*> m_chunks;
+      char padding[64];
+      // Shared: items freed since the owner last looked
+      FreeElement * volatile m_returned;
+
+      static UInt64 countList(FreeElement *elem)
+      {
+         UInt64 count = 0;
+         for(; elem; elem = elem->next)
+            ++count;
+         return count;
+      }
+
+   public:
+      SingleOwnerAllocator()
+         : m_free(NULL)
+         , m_returned(NULL)
+      {}
+
+      virtual ~SingleOwnerAllocator()
+      {
+         UInt64 items = m_chunks.size() * ChunkItems - countList(m_free) - countList(m_returned);
+         if (items)
+            printf("[ALLOC] %" PRIu64 " items of %u bytes not freed\n", items, (unsigned)ElemSize);
+         for(std::vector<char*>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+            delete [] *it;
+      }
+
+      virtual void* alloc(size_t bytes)
+      {
+         //LOG_ASSERT_ERROR(bytes <= ElemSize, "");
+         if (m_free == NULL)
+         {
+            m_free = __atomic_exchange_n(&m_returned, (FreeElement*)NULL, __ATOMIC_ACQUIRE);
+            if (m_free == NULL)
+            {
+               char *chunk = new char[ChunkItems * STRIDE];
+               m_chunks.push_back(chunk);
+               for(unsigned i = 0; i < ChunkItems; ++i)
+               {
+                  FreeElement *elem = (FreeElement *)(chunk + i * STRIDE);
+                  elem->allocator = this;
+                  elem->next = m_free;
+                  m_free = elem;
+               }
+            }
+         }
+         DataElement *elem = (DataElement *)m_free;
+         m_free = m_free->next;
+         return elem->data;
+      }
+
+      virtual void _dealloc(void* ptr)
+      {
+         FreeElement *elem = (FreeElement *)ptr;
+         FreeElement *head = __atomic_load_n(&m_returned, __ATOMIC_RELAXED);
+         do
+            elem->next = head;
+         while (!__atomic_compare_exchange_n(&m_returned, &head, elem, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+      }
+};
+
 #endif // __ALLOCATOR_H
@@ -8,9 +8,9 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
-// Enable to run core performance model in separate thread
+// ENABLE_PERF_MODEL_OWN_THREAD runs the core performance model in a separate thread
+// (build with `make PERF_MODEL_OWN_THREAD=1`, after a `make clean`, see common/Makefile.common)
 // When # simulated cores > # host cores, this is probably not very useful
-//#define ENABLE_PERF_MODEL_OWN_THREAD
 
 #include "fixed_types.h"
 #include "clock_skew_minimization_object.h"
@@ -0,0 +1,203 @@
+#ifndef __FLAT_HASH_MAP_H
+#define __FLAT_HASH_MAP_H
+
+#include "fixed_types.h"
+
+// Hash map from integer keys (addresses, page numbers) to small values, using open addressing with linear probing.
+//
+// All entries live in a single power-of-two sized array, which is kept at most half full.
+// A lookup hashes to a slot and scans the next few (usually one or two) adjacent slots,
+// rather than following pointers to separately allocated nodes as std::unordered_map does.
+// The all-ones key marks empty slots, it is stored separately if it is used as a real key.
+// As with std::unordered_map, references to values are invalidated when the map grows. Not thread safe.
+template <typename K, typename V> class FlatHashMap
+{
+   public:
+      struct Entry
+      {
+         K first;
+         V second;
+      };
+
+      class iterator
+      {
+         private:
+            FlatHashMap *m_map;
+            UInt64 m_index; // m_capacity: the separately stored all-ones key
+            void skip()
+            {
+               while (m_index < m_map->m_capacity && m_map->m_entries[m_index].first == EMPTY)
+                  ++m_index;
+               if (m_index == m_map->m_capacity && !m_map->m_has_empty_key)
+                  ++m_index;
+            }
+         public:
+            iterator(FlatHashMap *map, UInt64 index) : m_map(map), m_index(index) { skip(); }
+            Entry& operator*() const { return m_index < m_map->m_capacity ? m_map->m_entries[m_index] : m_map->m_empty_key_entry; }
+            Entry* operator->() const { return &**this; }
+            iterator& operator++() { ++m_index; skip(); return *this; }
+            bool operator==(const iterator& rhs) const { return m_map == rhs.m_map && m_index == rhs.m_index; }
+            bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+      };
+
+      FlatHashMap(UInt64 capacity = 64)
+         : m_entries(NULL)
+         , m_size(0)
+         , m_has_empty_key(false)
+      {
+         UInt64 bits = 4;
+         while ((1ULL << bits) < 2 * capacity)
+            ++bits;
+         allocate(bits);
+      }
+
+      ~FlatHashMap()
+      {
+         delete [] m_entries;
+      }
+
+      UInt64 size() const { return m_size; }
+      bool empty() const { return m_size == 0; }
+
+      // Pointer to the value for key, or NULL if key is not in the map
+      V* find(K key)
+      {
+         if (key == EMPTY)
+            return m_has_empty_key ? &m_empty_key_entry.second : NULL;
+         for(UInt64 index = hash(key); ; index = (index + 1) & m_mask)
+         {
+            if (m_entries[index].first == key)
+               return &m_entries[index].second;
+            else if (m_entries[index].first == EMPTY)
+               return NULL;
+         }
+      }
+
+      UInt64 count(K key) { return find(key) ? 1 : 0; }
+
+      // Value for key, inserting a value-initialized one if key is not yet in the map
+      V& operator[](K key)
+      {
+         if (key == EMPTY)
+         {
+            if (!m_has_empty_key)
+            {
+               m_has_empty_key = true;
+               m_empty_key_entry.first = key;
+               m_empty_key_entry.second = V();
+               ++m_size;
+            }
+            return m_empty_key_entry.second;
+         }
+         UInt64 index = hash(key);
+         for(; m_entries[index].first != EMPTY; index = (index + 1) & m_mask)
+         {
+            if (m_entries[index].first == key)
+               return m_entries[index].second;
+         }
+         if (2 * (m_size + 1) > m_capacity)
+         {
+            grow();
+            for(index = hash(key); m_entries[index].first != EMPTY; index = (index + 1) & m_mask) ;
+         }
+         m_entries[index].first = key;
+         m_entries[index].second = V();
+         ++m_size;
+         return m_entries[index].second;
+      }
+
+      bool erase(K key)
+      {
+         if (key == EMPTY)
+         {
+            if (!m_has_empty_key)
+               return false;
+            m_has_empty_key = false;
+            --m_size;
+            return true;
+         }
+         UInt64 index = hash(key);
+         for(; m_entries[index].first != key; index = (index + 1) & m_mask)
+         {
+            if (m_entries[index].first == EMPTY)
+               return false;
+         }
+         // Move back later entries of the same cluster that would no longer be found past the new hole
+         for(UInt64 next = (index + 1) & m_mask; m_entries[next].first != EMPTY; next = (next + 1) & m_mask)
+         {
+            UInt64 home = hash(m_entries[next].first);
+            if (((next - home) & m_mask) >= ((next - index) & m_mask))
+            {
+               m_entries[index] = m_entries[next];
+               index = next;
+            }
+         }
+         m_entries[index].first = EMPTY;
+         --m_size;
+         return true;
+      }
+
+      void clear()
+      {
+         for(UInt64 index = 0; index < m_capacity; ++index)
+            m_entries[index].first = EMPTY;
+         m_has_empty_key = false;
+         m_size = 0;
+      }
+
+      iterator begin() { return iterator(this, 0); }
+      iterator end() { return iterator(this, m_capacity + 1); }
+
+   private:
+      static const K EMPTY = K(-1);
+
+      Entry *m_entries;
+      UInt64 m_capacity;
+      UInt64 m_mask;
+      UInt64 m_bits;
+      UInt64 m_size;
+      bool m_has_empty_key;
+      Entry m_empty_key_entry;
+
+      // Not copyable: copies would share (and both delete) m_entries
+      FlatHashMap(const FlatHashMap&);
+      FlatHashMap& operator=(const FlatHashMap&);
+
+      UInt64 hash(K key) const
+      {
+         // Fibonacci hashing: the top bits of the product depend on all bits of the key
+         return (UInt64(key) * 0x9E3779B97F4A7C15ULL) >> (64 - m_bits);
+      }
+
+      void allocate(UInt64 bits)
+      {
+         m_bits = bits;
+         m_capacity = 1ULL << bits;
+         m_mask = m_capacity - 1;
+         m_entries = new Entry[m_capacity];
+         for(UInt64 index = 0; index < m_capacity; ++index)
+            m_entries[index].first = EMPTY;
+      }
+
+      void grow()
+      {
+         Entry *entries = m_entries;
+         UInt64 capacity = m_capacity;
+         allocate(m_bits + 1);
+         for(UInt64 i = 0; i < capacity; ++i)
+         {
+            if (entries[i].first != EMPTY)
+            {
+               UInt64 index = hash(entries[i].first);
+               while (m_entries[index].first != EMPTY)
+                  index = (index + 1) & m_mask;
+               m_entries[index] = entries[i];
+            }
+         }
+         delete [] entries;
+      }
+};
+
+template <typename K, typename V> const K FlatHashMap<K, V>::EMPTY;
+
+#endif // __FLAT_HASH_MAP_H
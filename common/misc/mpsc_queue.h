@@ -0,0 +1,144 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "fixed_types.h"
+
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Unbounded lock-free queue with many producer threads and a single consumer thread.
+//
+// The queue is intrusive: items embed a Link, so pushing does not allocate.
+// Producers append with a single atomic exchange on the head, the consumer walks the list from the tail
+// (Vyukov's algorithm, with a stub link so the queue never becomes empty of links).
+// An item is no longer referenced by the queue once it has been popped, so the consumer can free it.
+// A consumer that finds the queue empty sleeps on a futex, producers only make the wake-up system call
+// when they see the sleeping flag.
+class MPSCQueue
+{
+   public:
+      struct Link
+      {
+         Link * volatile next;
+      };
+
+   private:
+      // Producers: most recently pushed link
+      Link * volatile m_head;
+      UInt8 padding1[56];
+      // Consumer: oldest link, m_stub when the stub is in the list
+      Link *m_tail;
+      Link m_stub;
+      volatile UInt32 m_consumer_waiting;
+      volatile UInt32 m_consumer_futex;
+      UInt8 padding2[40];
+
+      void append(Link *link)
+      {
+         __atomic_store_n(&link->next, (Link*)NULL, __ATOMIC_RELAXED);
+         // Publish the link's contents together with the exchange, the consumer reads them after following prev->next
+         Link *prev = __atomic_exchange_n(&m_head, link, __ATOMIC_ACQ_REL);
+         // Between the exchange and this store, the consumer cannot see link (or anything pushed after it) yet
+         __atomic_store_n(&prev->next, link, __ATOMIC_RELEASE);
+      }
+
+   public:
+      MPSCQueue()
+         : m_head(&m_stub)
+         , m_tail(&m_stub)
+         , m_consumer_waiting(0)
+         , m_consumer_futex(0)
+      {
+         m_stub.next = NULL;
+      }
+
+      // Producer interface, can be called from any thread
+
+      void push(Link *link)
+      {
+         append(link);
+         // Make the new link visible before checking whether the consumer is going to sleep
+         __sync_synchronize();
+         if (__atomic_load_n(&m_consumer_waiting, __ATOMIC_RELAXED))
+         {
+            __sync_fetch_and_add(&m_consumer_futex, 1);
+            syscall(SYS_futex, (void*) &m_consumer_futex, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+         }
+      }
+
+      // For queues whose consumer never waits in pop(): saves the memory barrier needed to check for a sleeping consumer
+      void pushNoWake(Link *link)
+      {
+         append(link);
+      }
+
+      // Can be called from any thread, but is only exact on the consumer thread
+      bool empty()
+      {
+         return __atomic_load_n(&m_tail, __ATOMIC_RELAXED) == &m_stub && __atomic_load_n(&m_stub.next, __ATOMIC_ACQUIRE) == NULL;
+      }
+
+      // Consumer interface
+
+      // Remove and return the oldest item without waiting.
+      // Returns NULL if the queue is empty, or a producer is still in the middle of pushing the oldest item
+      Link* tryPop()
+      {
+         Link *tail = m_tail;
+         Link *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+         if (tail == &m_stub)
+         {
+            if (next == NULL)
+               return NULL;
+            tail = next;
+            __atomic_store_n(&m_tail, tail, __ATOMIC_RELAXED);
+            next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+         }
+         if (next)
+         {
+            __atomic_store_n(&m_tail, next, __ATOMIC_RELAXED);
+            return tail;
+         }
+         if (tail != __atomic_load_n(&m_head, __ATOMIC_ACQUIRE))
+            return NULL;
+         // tail is the only item: put the stub behind it so we can take it out
+         append(&m_stub);
+         next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+         if (next)
+         {
+            __atomic_store_n(&m_tail, next, __ATOMIC_RELAXED);
+            return tail;
+         }
+         return NULL;
+      }
+
+      // Remove and return the oldest item, waiting until there is one
+      Link* pop()
+      {
+         while (true)
+         {
+            if (Link *link = tryPop())
+               return link;
+
+            UInt32 value = __atomic_load_n(&m_consumer_futex, __ATOMIC_RELAXED);
+            __atomic_store_n(&m_consumer_waiting, 1, __ATOMIC_RELAXED);
+            // Make our waiting flag visible before checking the queue again, push() does the opposite
+            __sync_synchronize();
+            Link *link = tryPop();
+            if (link == NULL)
+            {
+               if (__atomic_load_n(&m_tail, __ATOMIC_RELAXED) == &m_stub && __atomic_load_n(&m_head, __ATOMIC_ACQUIRE) == &m_stub)
+                  syscall(SYS_futex, (void*) &m_consumer_futex, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, value, NULL, NULL, 0);
+               else
+                  sched_yield(); // A producer is between its exchange and linking in its item, it will be done shortly
+            }
+            __atomic_store_n(&m_consumer_waiting, 0, __ATOMIC_RELAXED);
+            if (link)
+               return link;
+         }
+      }
+};
+
+#endif // MPSC_QUEUE_H
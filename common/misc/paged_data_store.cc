@@ -0,0 +1,60 @@
+#include "paged_data_store.h"
+#include "log.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+
+DataArena::DataArena(UInt64 chunk_size)
+   : m_chunk_size(chunk_size)
+   , m_next(NULL)
+   , m_end(NULL)
+{
+}
+
+DataArena::~DataArena()
+{
+   for(std::vector<std::pair<char*, UInt64> >::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+      munmap(it->first, it->second);
+}
+
+void*
+DataArena::allocate(UInt64 size, UInt64 align)
+{
+   ScopedLock sl(m_lock);
+
+   char *ptr = (char*)(((IntPtr)m_next + align - 1) & ~(IntPtr)(align - 1));
+   if (m_next == NULL || ptr + size > m_end)
+   {
+      // Start a new chunk (mmap returns page-aligned memory), large allocations get a chunk of their own
+      UInt64 length = std::max(m_chunk_size, size + align);
+      void *chunk = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      LOG_ASSERT_ERROR(chunk != MAP_FAILED, "Could not map %ld bytes of simulated data storage", length);
+      m_chunks.push_back(std::pair<char*, UInt64>((char*)chunk, length));
+
+      m_next = (char*)chunk;
+      m_end = m_next + length;
+      ptr = (char*)(((IntPtr)m_next + align - 1) & ~(IntPtr)(align - 1));
+   }
+
+   m_next = ptr + size;
+   return ptr;
+}
+
+PagedDataStore::PagedDataStore(DataArena *arena)
+   : m_arena(arena)
+   , m_last_region(~0ULL)
+   , m_last_table(NULL)
+{
+}
+
+Byte**
+PagedDataStore::getTable(UInt64 region)
+{
+   Byte** &table = m_tables[region];
+   if (table == NULL)
+      table = (Byte**)m_arena->allocate(sizeof(Byte*) << TABLE_BITS, PAGE_BYTES);
+
+   m_last_region = region;
+   m_last_table = table;
+   return table;
+}
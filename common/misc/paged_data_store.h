@@ -0,0 +1,65 @@
+#ifndef __PAGED_DATA_STORE_H
+#define __PAGED_DATA_STORE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+#include <unordered_map>
+#include <vector>
+
+// Backing memory for simulated data (cache data arrays, DRAM contents).
+//
+// Memory is carved out of large anonymous, MAP_NORESERVE mappings. These read as zero, and the kernel only
+// backs a page with physical memory once it is written to: until then all reads map its shared zero page.
+// Memory is never returned to the arena, only when the arena itself is destroyed.
+class DataArena
+{
+   public:
+      DataArena(UInt64 chunk_size = 1ULL << 30);
+      ~DataArena();
+
+      // Zero-filled memory, aligned to align bytes (a power of two)
+      void* allocate(UInt64 size, UInt64 align = 64);
+
+   private:
+      const UInt64 m_chunk_size;
+      Lock m_lock;
+      std::vector<std::pair<char*, UInt64> > m_chunks;
+      char* m_next;
+      char* m_end;
+};
+
+// Sparse, lazily populated data store indexed by address.
+// Two-level table: a hash map of 1 GB regions, each a direct-mapped table of 4 KB pages.
+// Pages and page tables are allocated from a DataArena. Not thread safe.
+class PagedDataStore
+{
+   public:
+      static const UInt32 PAGE_BITS = 12;
+      static const UInt32 TABLE_BITS = 18;
+      static const UInt64 PAGE_BYTES = 1ULL << PAGE_BITS;
+
+      PagedDataStore(DataArena *arena);
+
+      // Pointer to the data at address, which is zero if never written to.
+      // Data is contiguous up to the next 4 KB boundary.
+      Byte* getData(IntPtr address)
+      {
+         UInt64 region = address >> (PAGE_BITS + TABLE_BITS);
+         Byte** table = region == m_last_region ? m_last_table : getTable(region);
+         Byte*& page = table[(address >> PAGE_BITS) & ((1ULL << TABLE_BITS) - 1)];
+         if (page == NULL)
+            page = (Byte*)m_arena->allocate(PAGE_BYTES, PAGE_BYTES);
+         return page + (address & (PAGE_BYTES - 1));
+      }
+
+   private:
+      DataArena *m_arena;
+      std::unordered_map<UInt64, Byte**> m_tables;
+      UInt64 m_last_region;
+      Byte** m_last_table;
+
+      Byte** getTable(UInt64 region);
+};
+
+#endif // __PAGED_DATA_STORE_H
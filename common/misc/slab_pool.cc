@@ -0,0 +1,83 @@
+#include "slab_pool.h"
+#include "log.h"
+
+#include <sched.h>
+
+SlabPool::SlabPool(UInt32 buffer_size, UInt32 buffers_per_slab)
+   : m_buffer_size((buffer_size + sizeof(Header) - 1) & ~(sizeof(Header) - 1))
+   , m_buffers_per_slab(buffers_per_slab)
+   , m_alloc_lock(0)
+   , m_free_list(NULL)
+{
+   LOG_ASSERT_ERROR(sizeof(Header) == 16, "SlabPool::Header should be 16 bytes, is %u", (UInt32)sizeof(Header));
+}
+
+SlabPool::~SlabPool()
+{
+   for(std::vector<Byte*>::iterator it = m_slabs.begin(); it != m_slabs.end(); ++it)
+      delete [] *it;
+}
+
+void SlabPool::allocateSlab()
+{
+   const UInt32 stride = sizeof(Header) + m_buffer_size;
+   Byte *slab = new Byte[m_buffers_per_slab * stride];
+   m_slabs.push_back(slab);
+
+   for(UInt32 i = 0; i < m_buffers_per_slab; ++i)
+   {
+      Header *header = (Header*)(slab + i * stride);
+      header->pool = this;
+      header->link.next = m_free_list;
+      m_free_list = &header->link;
+   }
+}
+
+Byte* SlabPool::alloc(UInt32 length)
+{
+   Header *header;
+
+   if (length > m_buffer_size)
+   {
+      header = (Header*)new Byte[sizeof(Header) + length];
+      header->pool = NULL;
+      return (Byte*)(header + 1);
+   }
+
+   while (__sync_lock_test_and_set(&m_alloc_lock, 1))
+      while (m_alloc_lock)
+         sched_yield();
+
+   MPSCQueue::Link *link = m_free_list;
+   if (link)
+      m_free_list = link->next;
+   else
+   {
+      // We are the only consumer of m_returned, as long as we hold the lock
+      link = m_returned.tryPop();
+      if (link == NULL)
+      {
+         allocateSlab();
+         link = m_free_list;
+         m_free_list = link->next;
+      }
+   }
+
+   __sync_lock_release(&m_alloc_lock);
+
+   header = (Header*)link;
+   return (Byte*)(header + 1);
+}
+
+void SlabPool::free(Byte *buffer)
+{
+   if (buffer == NULL)
+      return;
+
+   Header *header = (Header*)buffer - 1;
+
+   if (header->pool)
+      header->pool->m_returned.pushNoWake(&header->link);
+   else
+      delete [] (Byte*)header;
+}
@@ -0,0 +1,48 @@
+#ifndef SLAB_POOL_H
+#define SLAB_POOL_H
+
+#include "fixed_types.h"
+#include "mpsc_queue.h"
+
+#include <vector>
+
+// Pool of fixed-size buffers, carved out of large slabs so sending a message does not go through malloc.
+//
+// Buffers are allocated by the threads that own the pool (serialized by a spin lock, which is uncontended
+// unless the user and simulation threads of a core send at the same time), and can be freed from any thread:
+// they are pushed back onto the lock-free queue of the pool they came from, which alloc() drains.
+// Requests larger than the buffer size are served by new [].
+// Memory is returned to the system only when the pool is deleted, at which point no buffers may be in use.
+class SlabPool
+{
+   public:
+      SlabPool(UInt32 buffer_size, UInt32 buffers_per_slab);
+      ~SlabPool();
+
+      Byte* alloc(UInt32 length);
+      // Can be called from any thread, for buffers from any pool
+      static void free(Byte *buffer);
+
+   private:
+      // Stored in front of each buffer, 16 bytes so buffers keep the alignment of new []
+      struct Header
+      {
+         MPSCQueue::Link link;
+         SlabPool *pool;       // NULL for buffers that were not allocated from a slab
+      };
+
+      const UInt32 m_buffer_size;
+      const UInt32 m_buffers_per_slab;
+
+      // A full Lock costs more than the allocation itself, and is only ever held for a few instructions
+      volatile UInt32 m_alloc_lock;
+      // Free buffers only touched by alloc(), linked through their headers
+      MPSCQueue::Link *m_free_list;
+      // Buffers freed by any thread
+      MPSCQueue m_returned;
+      std::vector<Byte*> m_slabs;
+
+      void allocateSlab();
+};
+
+#endif // SLAB_POOL_H
@@ -0,0 +1,228 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include "fixed_types.h"
+
+#include <assert.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Lock-free ring buffer between a single producer thread and a single consumer thread.
+//
+// Each side works on its own private index and only exchanges it with the other side in batches:
+// the producer publishes the items it pushed (explicitly, or automatically every batch items),
+// the consumer releases the slots it has popped (every batch items, or when it runs out of work).
+// Shared indices are on cache lines of their own, so the steady state costs one cache line transfer per batch.
+// A side that cannot make progress (full ring, or nothing to consume) sleeps on a futex,
+// the other side only makes the wake-up system call when it sees the sleeping flag.
+template <class T> class SPSCQueue
+{
+   private:
+      // Producer side
+      UInt32 m_write;               // next slot to write
+      UInt32 m_head_cache;          // last seen value of m_head
+      volatile UInt32 m_producer_waiting;
+      volatile UInt32 m_producer_futex;
+      UInt8 padding1[48];
+      // Shared: end of published items, written by producer
+      volatile UInt32 m_tail;
+      UInt8 padding2[60];
+      // Shared: end of released slots, written by consumer
+      volatile UInt32 m_head;
+      UInt8 padding3[60];
+      // Consumer side
+      UInt32 m_read;                // next slot to read
+      UInt32 m_tail_cache;          // last seen value of m_tail
+      volatile UInt32 m_consumer_waiting;
+      volatile UInt32 m_consumer_futex;
+      volatile bool m_interrupted;
+      volatile bool m_notified;
+      UInt8 padding4[43];
+
+      const UInt32 m_size;
+      const UInt32 m_mask;
+      const UInt32 m_batch;
+      T* const m_queue;
+
+      static UInt32 roundUp(UInt32 size)
+      {
+         UInt32 result = 1;
+         while (result < size)
+            result <<= 1;
+         return result;
+      }
+
+      static void futexWait(volatile UInt32 *futx, UInt32 value)
+      {
+         // Returns immediately if *futx no longer equals value, spurious wake-ups are handled by our callers
+         syscall(SYS_futex, (void*) futx, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, value, NULL, NULL, 0);
+      }
+
+      static void futexWake(volatile UInt32 *futx)
+      {
+         __sync_fetch_and_add(futx, 1);
+         syscall(SYS_futex, (void*) futx, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, INT_MAX, NULL, NULL, 0);
+      }
+
+      // Producer: wait until at most count items are still outstanding (published but not released)
+      void waitReleased(UInt32 count)
+      {
+         while (m_write - (m_head_cache = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE)) > count)
+         {
+            UInt32 value = m_producer_futex;
+            m_producer_waiting = 1;
+            // Make our waiting flag visible before checking m_head again, release() does the opposite
+            __sync_synchronize();
+            if (m_write - m_head > count)
+               futexWait(&m_producer_futex, value);
+            m_producer_waiting = 0;
+         }
+      }
+
+   public:
+      SPSCQueue(UInt32 size = 64, UInt32 batch = 16)
+         : m_write(0)
+         , m_head_cache(0)
+         , m_producer_waiting(0)
+         , m_producer_futex(0)
+         , m_tail(0)
+         , m_head(0)
+         , m_read(0)
+         , m_tail_cache(0)
+         , m_consumer_waiting(0)
+         , m_consumer_futex(0)
+         , m_interrupted(false)
+         , m_notified(false)
+         , m_size(roundUp(size))
+         , m_mask(m_size - 1)
+         , m_batch(batch < m_size ? batch : m_size)
+         , m_queue(new T[m_size])
+      {
+      }
+
+      ~SPSCQueue()
+      {
+         delete [] m_queue;
+      }
+
+      // Producer interface
+
+      // Append an item, waits for the consumer while the ring is full
+      void push(const T& t)
+      {
+         if (m_write - m_head_cache == m_size)
+         {
+            m_head_cache = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+            if (m_write - m_head_cache == m_size)
+            {
+               publish();
+               waitReleased(m_size - 1);
+            }
+         }
+         m_queue[m_write & m_mask] = t;
+         ++m_write;
+         if (m_write - m_tail >= m_batch)
+            publish();
+      }
+
+      // Make all pushed items visible to the consumer
+      void publish()
+      {
+         if (m_write == m_tail)
+            return;
+         __atomic_store_n(&m_tail, m_write, __ATOMIC_RELEASE);
+         // Make the new tail visible before checking whether the consumer is going to sleep
+         __sync_synchronize();
+         if (m_consumer_waiting)
+            futexWake(&m_consumer_futex);
+      }
+
+      // Publish, and wait until the consumer has processed (and released) all items
+      void flush()
+      {
+         publish();
+         waitReleased(0);
+      }
+
+      // Consumer interface
+
+      bool empty()
+      {
+         if (m_read == m_tail_cache)
+            m_tail_cache = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+         return m_read == m_tail_cache;
+      }
+
+      T& front()
+      {
+         assert(!empty());
+         return m_queue[m_read & m_mask];
+      }
+
+      // Done with the front item, its slot is handed back to the producer at the end of the batch
+      void pop()
+      {
+         assert(!empty());
+         ++m_read;
+         if (m_read - m_head >= m_batch)
+            release();
+      }
+
+      // Hand back all popped slots to the producer
+      void release()
+      {
+         if (m_read == m_head)
+            return;
+         __atomic_store_n(&m_head, m_read, __ATOMIC_RELEASE);
+         __sync_synchronize();
+         if (m_producer_waiting)
+            futexWake(&m_producer_futex);
+      }
+
+      // Release all popped slots, then wait for new items to be published, or for notify().
+      // Returns false (without waiting) once interrupt() has been called.
+      bool wait()
+      {
+         release();
+         while (empty())
+         {
+            if (m_interrupted)
+               return false;
+            if (m_notified)
+            {
+               m_notified = false;
+               return true;
+            }
+            UInt32 value = m_consumer_futex;
+            m_consumer_waiting = 1;
+            // Make our waiting flag visible before checking m_tail again, publish() and notify() do the opposite
+            __sync_synchronize();
+            if (m_read == m_tail && !m_interrupted && !m_notified)
+               futexWait(&m_consumer_futex, value);
+            m_consumer_waiting = 0;
+         }
+         return true;
+      }
+
+      // Can be called from any thread: make the consumer return from wait(), even when nothing was published
+      // (it has other work, which the caller of notify() handed to it outside of this queue)
+      void notify()
+      {
+         m_notified = true;
+         __sync_synchronize();
+         if (m_consumer_waiting)
+            futexWake(&m_consumer_futex);
+      }
+
+      // Can be called from any thread: make the consumer return from wait()
+      void interrupt()
+      {
+         m_interrupted = true;
+         __sync_synchronize();
+         futexWake(&m_consumer_futex);
+      }
+};
+
+#endif // SPSC_QUEUE_H
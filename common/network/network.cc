@@ -95,8 +95,7 @@ void Network::netPullFromTransport()
          // if this isn't a broadcast message, then we shouldn't process it further
          if (packet.receiver != NetPacket::BROADCAST)
          {
-            if (packet.length > 0)
-               delete [] (Byte*) packet.data;
+            packet.release();
             continue;
          }
       }
@@ -117,8 +116,7 @@ void Network::netPullFromTransport()
 
          callback(_callbackObjs[packet.type], packet);
 
-         if (packet.length > 0)
-            delete [] (Byte*) packet.data;
+         packet.release();
       }
 
       // synchronous I/O support
@@ -147,7 +145,7 @@ NetworkModel* Network::getNetworkModelFromPacketType(PacketType packet_type)
    return _models[g_type_to_static_network_map[packet_type]];
 }
 
-SInt32 Network::netSend(NetPacket& packet)
+SInt32 Network::netSend(NetPacket& packet, const NetPacketWriter *writer)
 {
    assert(packet.type >= 0 && packet.type < NUM_PACKET_TYPES);
 
@@ -158,7 +156,6 @@ SInt32 Network::netSend(NetPacket& packet)
    std::vector<NetworkModel::Hop> hopVec;
    model->routePacket(packet, hopVec);
 
-   Byte *buffer = packet.makeBuffer();
    SubsecondTime start_time = packet.time;
 
    for (UInt32 i = 0; i < hopVec.size(); i++)
@@ -188,6 +185,10 @@ SInt32 Network::netSend(NetPacket& packet)
          }
       }
 
+      // Each hop gets its own buffer, which is handed to the receiver without further copies
+      Byte *buffer = _transport->allocBuffer(packet.bufferSize());
+      packet.writeBuffer(buffer, writer);
+
       NetPacket* buff_pkt = (NetPacket*) buffer;
 
       if (_core->getId() == buff_pkt->sender)
@@ -196,13 +197,11 @@ SInt32 Network::netSend(NetPacket& packet)
       buff_pkt->time = hopVec[i].time;
       buff_pkt->receiver = hopVec[i].final_dest;
 
-      _transport->send(hopVec[i].next_dest, buffer, packet.bufferSize());
+      _transport->sendBuffer(hopVec[i].next_dest, buffer, packet.bufferSize());
 
       LOG_PRINT("Sent packet");
    }
 
-   delete [] buffer;
-
    return packet.length;
 }
 
@@ -488,6 +487,7 @@ NetPacket::NetPacket()
    , receiver(INVALID_CORE_ID)
    , length(0)
    , data(0)
+   , buffer(NULL)
 {
 }
 
@@ -501,23 +501,35 @@ NetPacket::NetPacket(SubsecondTime t, PacketType ty, SInt32 s,
    , receiver(r)
    , length(l)
    , data(d)
+   , buffer(NULL)
 {
 }
 
 
-NetPacket::NetPacket(Byte *buffer)
+NetPacket::NetPacket(Byte *_buffer)
 {
-   memcpy(this, buffer, sizeof(*this));
+   memcpy(this, _buffer, sizeof(*this));
 
    // LOG_ASSERT_ERROR(length > 0, "type(%u), sender(%i), receiver(%i), length(%u)", type, sender, receiver, length);
    if (length > 0)
    {
-      Byte* data_buffer = new Byte[length];
-      memcpy(data_buffer, buffer + sizeof(*this), length);
-      data = data_buffer;
+      // Keep the data where the sender put it, it is freed together with the buffer by release()
+      buffer = _buffer;
+      data = _buffer + sizeof(*this);
+   }
+   else
+   {
+      buffer = NULL;
+      Transport::getSingleton()->freeBuffer(_buffer);
    }
+}
 
-   delete [] buffer;
+void NetPacket::release()
+{
+   if (buffer)
+      Transport::getSingleton()->freeBuffer(buffer);
+   buffer = NULL;
+   data = NULL;
 }
 
 // This implementation is slightly wasteful because there is no need
@@ -528,15 +540,11 @@ UInt32 NetPacket::bufferSize() const
    return (sizeof(*this) + length);
 }
 
-Byte* NetPacket::makeBuffer() const
+void NetPacket::writeBuffer(Byte *_buffer, const NetPacketWriter *writer) const
 {
-   UInt32 size = bufferSize();
-   assert(size >= sizeof(NetPacket));
-
-   Byte *buffer = new Byte[size];
-
-   memcpy(buffer, this, sizeof(*this));
-   memcpy(buffer + sizeof(*this), data, length);
-
-   return buffer;
+   memcpy(_buffer, this, sizeof(*this));
+   if (writer)
+      writer->write(_buffer + sizeof(*this));
+   else
+      memcpy(_buffer + sizeof(*this), data, length);
 }
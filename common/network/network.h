@@ -20,6 +20,16 @@ class Network;
 
 // -- Network Packets -- //
 
+// Writes the data of a packet straight into each transport buffer, for senders whose data
+// is not in one piece. The network models still see the packet's data pointer, which should
+// point to at least the start of the data as the writer lays it out.
+class NetPacketWriter
+{
+public:
+   virtual ~NetPacketWriter() { }
+   virtual void write(Byte *data) const = 0;
+};
+
 class NetPacket
 {
 public:
@@ -31,14 +41,18 @@ public:
    SInt32 receiver;
    UInt32 length;
    const void *data;
+   Byte *buffer;   // Transport buffer holding data, for received packets
 
    NetPacket();
+   // Takes ownership of a transport buffer, data points into it (no copy is made)
    explicit NetPacket(Byte*);
    NetPacket(SubsecondTime time, PacketType type, SInt32 sender,
              SInt32 receiver, UInt32 length, const void *data);
 
    UInt32 bufferSize() const;
-   Byte *makeBuffer() const;
+   void writeBuffer(Byte *buffer, const NetPacketWriter *writer = NULL) const;
+   // Free the data of a received packet
+   void release();
 
    static const SInt32 BROADCAST = 0xDEADBABE;
 };
@@ -82,7 +96,8 @@ class Network
 
       // -- Main interface -- //
 
-      SInt32 netSend(NetPacket& packet);
+      SInt32 netSend(NetPacket& packet, const NetPacketWriter *writer = NULL);
+      // Received packets are owned by the caller, who should call release() on them when done
       NetPacket netRecv(const NetMatch &match, UInt64 timeout_ns = 0);
 
       // -- Wrappers -- //
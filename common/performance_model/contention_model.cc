@@ -3,11 +3,17 @@
 #include "subsecond_time.h"
 #include "dvfs_manager.h"
 
+const UInt32 ContentionModel::INDEX_THRESHOLD;
+const UInt32 ContentionModel::NO_SLOT;
+
 ContentionModel::ContentionModel()
    : m_num_outstanding(1)
    , m_time(m_num_outstanding, std::make_pair(SubsecondTime::Zero(), 0))
    , m_t_last(SubsecondTime::Zero())
    , m_proc_period(NULL)
+   , m_indexed(false)
+   , m_tree_leaves(0)
+   , m_tag_bits(0)
    , m_n_requests(0)
    , m_n_barriers(0)
    , m_n_outoforder(0)
@@ -22,6 +28,9 @@ ContentionModel::ContentionModel(String name, core_id_t core_id, UInt32 num_outs
    , m_time(m_num_outstanding, std::make_pair(SubsecondTime::Zero(), 0))
    , m_t_last(SubsecondTime::Zero())
    , m_proc_period(Sim()->getDvfsManager()->getCoreDomain(core_id))
+   , m_indexed(false)
+   , m_tree_leaves(0)
+   , m_tag_bits(0)
    , m_n_requests(0)
    , m_n_barriers(0)
    , m_n_outoforder(0)
@@ -30,6 +39,8 @@ ContentionModel::ContentionModel(String name, core_id_t core_id, UInt32 num_outs
    , m_total_delay(SubsecondTime::Zero())
    , m_total_barrier_delay(SubsecondTime::Zero())
 {
+   initIndex();
+
    if (m_num_outstanding > 0)
    {
       registerStatsMetric(name, core_id, "num-requests", &m_n_requests);
@@ -45,6 +56,125 @@ ContentionModel::ContentionModel(String name, core_id_t core_id, UInt32 num_outs
 ContentionModel::~ContentionModel()
 {}
 
+void
+ContentionModel::initIndex()
+{
+   m_indexed = m_num_outstanding >= INDEX_THRESHOLD;
+   if (!m_indexed)
+      return;
+
+   m_tree_leaves = 1;
+   while (m_tree_leaves < m_num_outstanding)
+      m_tree_leaves <<= 1;
+   m_tree.assign(2 * m_tree_leaves, NO_SLOT);
+   for (UInt32 i = 0; i < m_num_outstanding; ++i)
+      m_tree[m_tree_leaves + i] = i;
+   for (UInt32 node = m_tree_leaves - 1; node > 0; --node)
+      m_tree[node] = getSlotTime(m_tree[2 * node + 1]) < getSlotTime(m_tree[2 * node]) ? m_tree[2 * node + 1] : m_tree[2 * node];
+
+   // At least twice as many buckets as there are slots
+   m_tag_bits = 1;
+   while ((1U << m_tag_bits) < 2 * m_num_outstanding)
+      ++m_tag_bits;
+   m_tag_bucket.assign(1U << m_tag_bits, NO_SLOT);
+   m_tag_next.assign(m_num_outstanding, NO_SLOT);
+   m_tag_prev.assign(m_num_outstanding, NO_SLOT);
+   for (UInt32 i = 0; i < m_num_outstanding; ++i)
+      linkTag(i);
+}
+
+void
+ContentionModel::linkTag(UInt32 slot)
+{
+   UInt32 &head = m_tag_bucket[getTagBucket(m_time[slot].second)];
+   m_tag_next[slot] = head;
+   m_tag_prev[slot] = NO_SLOT;
+   if (head != NO_SLOT)
+      m_tag_prev[head] = slot;
+   head = slot;
+}
+
+void
+ContentionModel::unlinkTag(UInt32 slot)
+{
+   if (m_tag_prev[slot] == NO_SLOT)
+      m_tag_bucket[getTagBucket(m_time[slot].second)] = m_tag_next[slot];
+   else
+      m_tag_next[m_tag_prev[slot]] = m_tag_next[slot];
+   if (m_tag_next[slot] != NO_SLOT)
+      m_tag_prev[m_tag_next[slot]] = m_tag_prev[slot];
+}
+
+void
+ContentionModel::setSlot(UInt32 slot, SubsecondTime time, UInt64 tag)
+{
+   if (!m_indexed)
+   {
+      m_time[slot].first = time;
+      m_time[slot].second = tag;
+      return;
+   }
+
+   if (m_time[slot].second != tag)
+   {
+      unlinkTag(slot);
+      m_time[slot].second = tag;
+      linkTag(slot);
+   }
+
+   m_time[slot].first = time;
+   for (UInt32 node = (m_tree_leaves + slot) / 2; node > 0; node /= 2)
+      m_tree[node] = getSlotTime(m_tree[2 * node + 1]) < getSlotTime(m_tree[2 * node]) ? m_tree[2 * node + 1] : m_tree[2 * node];
+}
+
+UInt32
+ContentionModel::findSlot(SubsecondTime t_start) const
+{
+   if (m_indexed)
+   {
+      if (getSlotTime(m_tree[1]) > t_start)
+         return m_tree[1];
+
+      // Walk down to the leftmost slot that is free at t_start
+      UInt32 node = 1;
+      while (node < m_tree_leaves)
+         node = getSlotTime(m_tree[2 * node]) <= t_start ? 2 * node : 2 * node + 1;
+      return m_tree[node];
+   }
+
+   UInt32 unit = 0;
+   for (UInt32 i = 0; i < m_num_outstanding; ++i)
+   {
+      if (m_time[i].first <= t_start)
+         /* This one is free now */
+         return i;
+      else if (m_time[i].first < m_time[unit].first)
+         /* Unit i is the first one free */
+         unit = i;
+   }
+   return unit;
+}
+
+UInt32
+ContentionModel::findTag(UInt64 tag) const
+{
+   if (m_indexed)
+   {
+      UInt32 first = NO_SLOT;
+      for (UInt32 slot = m_tag_bucket[getTagBucket(tag)]; slot != NO_SLOT; slot = m_tag_next[slot])
+         if (m_time[slot].second == tag && slot < first)
+            first = slot;
+      return first;
+   }
+
+   for (UInt32 i = 0; i < m_num_outstanding; ++i)
+   {
+      if (m_time[i].second == tag)
+         return i;
+   }
+   return NO_SLOT;
+}
+
 UInt32
 ContentionModel::getNumUsed(uint64_t t_start)
 {
@@ -55,6 +185,7 @@ ContentionModel::getNumUsed(uint64_t t_start)
 UInt32
 ContentionModel::getNumUsed(SubsecondTime t_start)
 {
+   // Only used for debug output, so not indexed
    UInt32 num_used = 0;
    for (UInt32 i = 0; i < m_num_outstanding; ++i)
    {
@@ -67,11 +198,9 @@ ContentionModel::getNumUsed(SubsecondTime t_start)
 SubsecondTime
 ContentionModel::getTagCompletionTime(UInt64 tag)
 {
-   for (UInt32 i = 0; i < m_num_outstanding; ++i)
-   {
-      if (m_time[i].second == tag)
-         return m_time[i].first;
-   }
+   UInt32 slot = findTag(tag);
+   if (slot != NO_SLOT)
+      return m_time[slot].first;
    return SubsecondTime::MaxTime();
 }
 
@@ -85,13 +214,13 @@ ContentionModel::hasFreeSlot(uint64_t t_start, UInt64 tag)
 bool
 ContentionModel::hasFreeSlot(SubsecondTime t_start, UInt64 tag)
 {
-   for (UInt32 i = 0; i < m_num_outstanding; ++i)
+   if (m_num_outstanding > 0)
    {
-      if (m_time[i].first <= t_start)
+      if (m_time[findSlot(t_start)].first <= t_start)
          return true;
 
       // When using tags: an identical tag that's already in process is also acceptable
-      if (m_time[i].second == tag)
+      if (findTag(tag) != NO_SLOT)
          return true;
    }
    ++m_n_hasfreefail;
@@ -101,12 +230,7 @@ ContentionModel::hasFreeSlot(SubsecondTime t_start, UInt64 tag)
 bool
 ContentionModel::hasTag(UInt64 tag)
 {
-   for (UInt32 i = 0; i < m_num_outstanding; ++i)
-   {
-      if (m_time[i].second == tag)
-         return true;
-   }
-   return false;
+   return findTag(tag) != NO_SLOT;
 }
 
 uint64_t
@@ -137,6 +261,8 @@ ContentionModel::getBarrierCompletionTime(SubsecondTime t_start, SubsecondTime t
     m_time[i].first = max_time + t_delay;
     m_time[i].second = tag;
   }
+  if (m_indexed)
+    initIndex();
 
   m_total_barrier_delay += max_time - t_start;
   ++m_n_barriers;
@@ -193,22 +319,8 @@ ContentionModel::getCompletionTime(SubsecondTime t_start, SubsecondTime t_delay,
       if (t_start == m_t_last)
          m_n_simultaneous ++;
 
-      UInt64 unit = 0;
       /* Find first free entry */
-      for(UInt32 i = 0; i < m_num_outstanding; ++i)
-      {
-         if (m_time[i].first <= t_start)
-         {
-            /* This one is free now */
-            unit = i;
-            break;
-         }
-         else if (m_time[i].first < m_time[unit].first)
-         {
-            /* Unit i is the first one free */
-            unit = i;
-         }
-      }
+      UInt32 unit = findSlot(t_start);
 
       SubsecondTime t_begin;
       if (t_start < m_time[unit].first)
@@ -220,8 +332,7 @@ ContentionModel::getCompletionTime(SubsecondTime t_start, SubsecondTime t_delay,
       /* Compute end of packet sending time */
       t_end = t_begin + t_delay;
 
-      m_time[unit].first = t_end;
-      m_time[unit].second = tag;
+      setSlot(unit, t_end, tag);
 
       /* Update statistics */
       m_total_delay += t_begin - t_start;
@@ -258,21 +369,8 @@ ContentionModel::getStartTime(SubsecondTime t_start)
    }
    else
    {
-      UInt64 unit = 0;
       /* Find first free entry */
-      for(UInt32 i = 0; i < m_num_outstanding; ++i)
-      {
-         if (m_time[i].first <= t_start)
-         {
-            /* This one is free now */
-            return t_start;
-         }
-         else if (m_time[i].first < m_time[unit].first)
-         {
-            /* Unit i is the first one free */
-            unit = i;
-         }
-      }
+      UInt32 unit = findSlot(t_start);
 
       if (t_start < m_time[unit].first)
          /* Delay until the time the first unit becomes free */
@@ -5,12 +5,46 @@
 #include "fixed_types.h"
 #include "subsecond_time.h"
 
+// From this number of slots on, slots are found through an index rather than by scanning all of them.
+// Can be overridden at build time, test/microbench/contention_model_crossover.cc uses this to find the crossover point.
+#ifndef CONTENTION_MODEL_INDEX_THRESHOLD
+#define CONTENTION_MODEL_INDEX_THRESHOLD 24
+#endif
+
 class ContentionModel {
    private:
+      static const UInt32 INDEX_THRESHOLD = CONTENTION_MODEL_INDEX_THRESHOLD;
+      static const UInt32 NO_SLOT = ~0U;
+
       UInt32 m_num_outstanding;
       std::vector<std::pair<SubsecondTime, UInt64> > m_time;
       SubsecondTime m_t_last;
       const ComponentPeriod *m_proc_period;
+
+      // Slot index, only used when there are at least INDEX_THRESHOLD slots:
+      // - m_tree is a tournament tree (a binary heap layout over the slots in their original order),
+      //   each node holds the slot with the earliest completion time in its subtree, the lowest numbered one on ties.
+      //   Leaves are at m_tree[m_tree_leaves + slot], padding leaves hold NO_SLOT.
+      // - m_tag_bucket is a hash table on tag, chaining together the slots holding that tag through m_tag_next/m_tag_prev.
+      // Lookups return the same slot a linear scan over m_time would have found.
+      bool m_indexed;
+      UInt32 m_tree_leaves;
+      std::vector<UInt32> m_tree;
+      UInt32 m_tag_bits;
+      std::vector<UInt32> m_tag_bucket;
+      std::vector<UInt32> m_tag_next;
+      std::vector<UInt32> m_tag_prev;
+
+      void initIndex();
+      SubsecondTime getSlotTime(UInt32 slot) const { return slot == NO_SLOT ? SubsecondTime::MaxTime() : m_time[slot].first; }
+      UInt32 getTagBucket(UInt64 tag) const { return (tag * 0x9E3779B97F4A7C15ULL) >> (64 - m_tag_bits); }
+      void linkTag(UInt32 slot);
+      void unlinkTag(UInt32 slot);
+      void setSlot(UInt32 slot, SubsecondTime time, UInt64 tag);
+      // The first slot that is free at t_start, or the one that becomes free first
+      UInt32 findSlot(SubsecondTime t_start) const;
+      // The first slot holding tag, or NO_SLOT
+      UInt32 findTag(UInt64 tag) const;
    public:
       UInt64 m_n_requests;
       UInt64 m_n_barriers;
@@ -5,7 +5,24 @@
 #include "branch_predictor.h"
 #include "performance_model.h"
 
-Allocator* DynamicInstruction::createAllocator()
+static_assert(sizeof(DynamicInstruction) == 32 && sizeof(DynamicInstruction::MemoryInfo) == 32,
+              "DynamicInstruction or MemoryInfo grew, allocator size classes may need updating");
+
+Allocator* DynamicInstruction::createAllocator(UInt8 max_memory)
+{
+   LOG_ASSERT_ERROR(max_memory <= MAX_MEMORY, "At most MAX_MEMORY(%d) memory operands are supported", MAX_MEMORY);
+   switch(max_memory)
+   {
+      case 0:
+         return new SingleOwnerAllocator<sizeof(DynamicInstruction)>();
+      case 1:
+         return new SingleOwnerAllocator<sizeof(DynamicInstruction) + 1 * sizeof(MemoryInfo)>();
+      default:
+         return new SingleOwnerAllocator<sizeof(DynamicInstruction) + MAX_MEMORY * sizeof(MemoryInfo)>();
+   }
+}
+
+Allocator* DynamicInstruction::createSharedAllocator()
 {
    return new TypedAllocator<DynamicInstruction, 1024>();
 }
@@ -30,7 +47,7 @@ SubsecondTime DynamicInstruction::getBranchCost(Core *core, bool *p_is_mispredic
    BranchPredictor *bp = perf->getBranchPredictor();
    const ComponentPeriod *period = core->getDvfsDomain();
 
-   bool is_mispredict = core->accessBranchPredictor(eip, branch_info.taken, branch_info.target);
+   bool is_mispredict = core->accessBranchPredictor(eip, branch_taken, branch_target);
    UInt64 cost = is_mispredict ? bp->getMispredictPenalty() : 1;
 
    if (p_is_mispredict)
@@ -43,26 +60,27 @@ void DynamicInstruction::accessMemory(Core *core)
 {
    for(UInt8 idx = 0; idx < num_memory; ++idx)
    {
-      if (memory_info[idx].executed && memory_info[idx].hit_where == HitWhere::UNKNOWN)
+      MemoryInfo &info = getMemoryInfo(idx);
+      if (info.executed && info.hit_where == HitWhere::UNKNOWN)
       {
          MemoryResult res = core->accessMemory(
             /*instruction.isAtomic()
                ? (info->type == DynamicInstructionInfo::MEMORY_READ ? Core::LOCK : Core::UNLOCK)
                :*/ Core::NONE, // Just as in pin/lite/memory_modeling.cc, make the second part of an atomic update implicit
-            memory_info[idx].dir == Operand::READ ? (instruction->isAtomic() ? Core::READ_EX : Core::READ) : Core::WRITE,
-            memory_info[idx].addr,
+            info.dir == Operand::READ ? (instruction->isAtomic() ? Core::READ_EX : Core::READ) : Core::WRITE,
+            info.addr,
             NULL,
-            memory_info[idx].size,
+            info.size,
             Core::MEM_MODELED_RETURN,
             instruction->getAddress()
          );
-         memory_info[idx].latency = res.latency;
-         memory_info[idx].hit_where = res.hit_where;
+         info.latency = res.latency;
+         info.hit_where = res.hit_where;
       }
       else
       {
-         memory_info[idx].latency = 1 * core->getDvfsDomain()->getPeriod(); // 1 cycle latency
-         memory_info[idx].hit_where = HitWhere::PREDICATE_FALSE;
+         info.latency = 1 * core->getDvfsDomain()->getPeriod(); // 1 cycle latency
+         info.hit_where = HitWhere::PREDICATE_FALSE;
       }
    }
 }
@@ -13,72 +13,78 @@ class DynamicInstruction
 {
    private:
       // Private constructor: alloc() should be used
-      DynamicInstruction(Instruction *ins, IntPtr _eip)
+      DynamicInstruction(Instruction *ins, IntPtr _eip, UInt8 _max_memory)
       {
          instruction = ins;
          eip = _eip;
-         branch_info.is_branch = false;
+         is_branch = false;
          num_memory = 0;
+         max_memory = _max_memory;
       }
    public:
-      struct BranchInfo
-      {
-         bool is_branch;
-         bool taken;
-         IntPtr target;
-      };
       struct MemoryInfo {
-         bool executed; // For CMOV: true if executed
-         Operand::Direction dir;
          IntPtr addr;
-         UInt32 size;
-         UInt32 num_misses;
          SubsecondTime latency;
-         HitWhere::where_t hit_where;
+         UInt32 num_misses;
+         UInt16 size;
+         bool executed; // For CMOV: true if executed
+         Operand::Direction dir : 8;
+         HitWhere::where_t hit_where : 8;
       };
       static const UInt8 MAX_MEMORY = 2;
 
+      // Only branch and memory information that is actually used takes up space:
+      // the MemoryInfo entries are stored directly behind the DynamicInstruction (see alloc()),
+      // and each instruction comes from the allocator for its number of memory operands.
       Instruction* instruction;
       IntPtr eip; // Can be physical address, so different from instruction->getAddress() which is always virtual
-      BranchInfo branch_info;
+      IntPtr branch_target;
+      bool is_branch;
+      bool branch_taken;
       UInt8 num_memory;
-      MemoryInfo memory_info[MAX_MEMORY];
+      UInt8 max_memory;
 
-      static Allocator* createAllocator();
+      // Single-owner allocator for instructions with max_memory MemoryInfo entries
+      static Allocator* createAllocator(UInt8 max_memory);
+      // Allocator that can be used by any thread (for pseudo instructions)
+      static Allocator* createSharedAllocator();
 
       ~DynamicInstruction();
 
-      static DynamicInstruction* alloc(Allocator *alloc, Instruction *ins, IntPtr eip)
+      static DynamicInstruction* alloc(Allocator *alloc, Instruction *ins, IntPtr eip, UInt8 max_memory = 0)
       {
-         void *ptr = alloc->alloc(sizeof(DynamicInstruction));
-         DynamicInstruction *i = new(ptr) DynamicInstruction(ins, eip);
+         void *ptr = alloc->alloc(sizeof(DynamicInstruction) + max_memory * sizeof(MemoryInfo));
+         DynamicInstruction *i = new(ptr) DynamicInstruction(ins, eip, max_memory);
          return i;
       }
       static void operator delete(void* ptr) { Allocator::dealloc(ptr); }
 
       SubsecondTime getCost(Core *core);
 
-      bool isBranch() const { return branch_info.is_branch; }
+      bool isBranch() const { return is_branch; }
       bool isMemory() const { return num_memory > 0; }
 
+      MemoryInfo& getMemoryInfo(UInt8 idx) { return ((MemoryInfo*)(this + 1))[idx]; }
+
       void addMemory(bool e, SubsecondTime l, IntPtr a, UInt32 s, Operand::Direction dir, UInt32 num_misses, HitWhere::where_t hit_where)
       {
-         LOG_ASSERT_ERROR(num_memory < MAX_MEMORY, "Got more than MAX_MEMORY(%d) memory operands", MAX_MEMORY);
-         memory_info[num_memory].dir = dir;
-         memory_info[num_memory].executed = e;
-         memory_info[num_memory].latency = l;
-         memory_info[num_memory].addr = a;
-         memory_info[num_memory].size = s;
-         memory_info[num_memory].num_misses = num_misses;
-         memory_info[num_memory].hit_where = hit_where;
+         LOG_ASSERT_ERROR(num_memory < max_memory, "Got more than %d memory operands", max_memory);
+         MemoryInfo &info = getMemoryInfo(num_memory);
+         info.dir = dir;
+         info.executed = e;
+         info.latency = l;
+         info.addr = a;
+         info.size = s;
+         info.num_misses = num_misses;
+         info.hit_where = hit_where;
          num_memory++;
       }
 
       void addBranch(bool taken, IntPtr target)
       {
-         branch_info.is_branch = true;
-         branch_info.taken = taken;
-         branch_info.target = target;
+         is_branch = true;
+         branch_taken = taken;
+         branch_target = target;
       }
 
       SubsecondTime getBranchCost(Core *core, bool *p_is_mispredict = NULL);
@@ -5,6 +5,8 @@
 #include "performance_model.h"
 #include "branch_predictor.h"
 #include "config.hpp"
+#include "micro_op_template.h"
+#include "micro_op.h"
 
 // Instruction
 
@@ -13,18 +15,44 @@ Instruction::StaticInstructionCosts Instruction::m_instruction_costs;
 Instruction::Instruction(InstructionType type, OperandList &operands)
    : m_type(type)
    , m_uops(NULL)
+   , m_uop_templates(NULL)
    , m_addr(0)
+   , m_num_memory(0)
    , m_operands(operands)
 {
+   for(OperandList::const_iterator it = m_operands.begin(); it != m_operands.end(); ++it)
+      if (it->m_type == Operand::MEMORY)
+         ++m_num_memory;
 }
 
 Instruction::Instruction(InstructionType type)
    : m_type(type)
    , m_uops(NULL)
+   , m_uop_templates(NULL)
    , m_addr(0)
+   , m_num_memory(0)
 {
 }
 
+Instruction::~Instruction()
+{
+   delete m_uop_templates;
+
+   if (m_uops)
+   {
+      for(std::vector<const MicroOp *>::const_iterator it = m_uops->begin(); it != m_uops->end(); ++it)
+         delete *it;
+      delete m_uops;
+   }
+}
+
+void Instruction::addMicroOpTemplate(MicroOpTemplate *uop_template) const
+{
+   do
+      uop_template->next = m_uop_templates;
+   while (!__sync_bool_compare_and_swap(&m_uop_templates, uop_template->next, uop_template));
+}
+
 InstructionType Instruction::getType() const
 {
     return m_type;
@@ -9,6 +9,7 @@
 
 class Core;
 class MicroOp;
+class MicroOpTemplate;
 
 enum InstructionType
 {
@@ -45,7 +46,7 @@ public:
 
    Instruction(InstructionType type);
 
-   virtual ~Instruction() { };
+   virtual ~Instruction();
    virtual SubsecondTime getCost(Core *core) const;
 
    InstructionType getType() const;
@@ -59,6 +60,9 @@ public:
 
    const OperandList& getOperands() const
    { return m_operands; }
+   // Number of MEMORY operands, for sizing DynamicInstructions
+   UInt8 getNumMemoryOperands() const
+   { return m_num_memory; }
 
    void setAddress(IntPtr addr) { m_addr = addr; }
    IntPtr getAddress() const { return m_addr; }
@@ -71,12 +75,18 @@ public:
    void setDisassembly(String str) { m_disas = str; }
    const String& getDisassembly(void) const { return m_disas; }
 
+   // Takes ownership of the vector and its MicroOps
    void setMicroOps(const std::vector<const MicroOp *> *uops)
    { m_uops = uops; }
 
    const std::vector<const MicroOp *>* getMicroOps(void) const
    { return m_uops; }
 
+   // Pre-decoded micro-ops, one MicroOpTemplate per core model (see MicroOpPerformanceModel)
+   MicroOpTemplate* getMicroOpTemplates() const
+   { return m_uop_templates; }
+   void addMicroOpTemplate(MicroOpTemplate *uop_template) const;
+
 private:
    typedef std::vector<unsigned int> StaticInstructionCosts;
    static StaticInstructionCosts m_instruction_costs;
@@ -85,10 +95,13 @@ private:
    String m_disas;
 
    const std::vector<const MicroOp *> *m_uops;
+   // Instructions can be shared between threads, templates are only ever added using an atomic compare-and-swap
+   mutable MicroOpTemplate * volatile m_uop_templates;
 
    IntPtr m_addr;
    UInt32 m_size;
    bool m_atomic;
+   UInt8 m_num_memory;
 
 protected:
    OperandList m_operands;
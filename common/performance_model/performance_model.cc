@@ -14,6 +14,8 @@
 #include "instruction_tracer.h"
 #include "dynamic_instruction.h"
 
+#include <algorithm>
+
 PerformanceModel* PerformanceModel::create(Core* core)
 {
    String type;
@@ -50,22 +52,25 @@ PerformanceModel* PerformanceModel::create(Core* core)
 // Public Interface
 PerformanceModel::PerformanceModel(Core *core)
    : m_core(core)
-   , m_dynins_alloc(DynamicInstruction::createAllocator())
+   , m_pseudo_dynins_alloc(DynamicInstruction::createSharedAllocator())
    , m_enabled(false)
    , m_fastforward(false)
    , m_fastforward_model(new FastforwardPerformanceModel(core, this))
    , m_detailed_sync(true)
-   , m_hold(false)
    , m_instruction_count(0)
    , m_elapsed_time(Sim()->getDvfsManager()->getCoreDomain(core->getId()))
    , m_idle_elapsed_time(Sim()->getDvfsManager()->getCoreDomain(core->getId()))
    #ifdef ENABLE_PERF_MODEL_OWN_THREAD
    , m_instruction_queue(256) // Reduce from default size to keep memory issue time more or less synchronized
+   , m_pseudo_pending(false)
    #else
    , m_instruction_queue(1024) // Need a bit more space for when the dyninsninfo items aren't coming in yet, or for a boatload of TLBMissInstructions
    #endif
    , m_current_ins_index(0)
 {
+   for(UInt8 max_memory = 0; max_memory <= DynamicInstruction::MAX_MEMORY; ++max_memory)
+      m_dynins_alloc.push_back(DynamicInstruction::createAllocator(max_memory));
+
    m_bp = BranchPredictor::create(core->getId());
 
    m_instruction_tracer = InstructionTracer::create(core);
@@ -139,13 +144,16 @@ void PerformanceModel::handleBranchMispredict()
 
 DynamicInstruction* PerformanceModel::createDynamicInstruction(Instruction *ins, IntPtr eip)
 {
-   return DynamicInstruction::alloc(m_dynins_alloc, ins, eip);
+   // Only called by the thread running on this core, so the single-owner allocators can be used
+   UInt8 max_memory = std::min(ins->getNumMemoryOperands(), DynamicInstruction::MAX_MEMORY);
+   return DynamicInstruction::alloc(m_dynins_alloc[max_memory], ins, eip, max_memory);
 }
 
 void PerformanceModel::queuePseudoInstruction(PseudoInstruction *i)
 {
    if (i->getType() == INST_SPAWN)
    {
+      drain();
       SpawnInstruction const* spawn_insn = dynamic_cast<SpawnInstruction const*>(i);
       LOG_ASSERT_ERROR(spawn_insn != NULL, "Expected a SpawnInstruction, but did not get one.");
       setElapsedTime(spawn_insn->getTime());
@@ -163,6 +171,8 @@ void PerformanceModel::queuePseudoInstruction(PseudoInstruction *i)
 
    if (i->isIdle())
    {
+      // Idle instructions update time directly, do this after all queued instructions have been simulated
+      drain();
       handleIdleInstruction(i);
       delete i;
    }
@@ -174,11 +184,20 @@ void PerformanceModel::queuePseudoInstruction(PseudoInstruction *i)
       }
       else
       {
-         #ifdef ENABLE_PERF_MODEL_OWN_THREAD
-            m_instruction_queue.push_wait(createDynamicInstruction(i, 0));
-         #else
-            m_instruction_queue.push(createDynamicInstruction(i, 0));
-         #endif
+         DynamicInstruction *ins = DynamicInstruction::alloc(m_pseudo_dynins_alloc, i, 0);
+#ifdef ENABLE_PERF_MODEL_OWN_THREAD
+         if (!isFrontEndThread())
+         {
+            {
+               ScopedLock sl(m_pseudo_lock);
+               m_pseudo_queue.push(ins);
+               m_pseudo_pending = true;
+            }
+            m_instruction_queue.notify();
+            return;
+         }
+#endif
+         m_instruction_queue.push(ins);
       }
    }
 }
@@ -193,11 +212,7 @@ void PerformanceModel::queueInstruction(DynamicInstruction *ins)
       return;
    }
 
-   #ifdef ENABLE_PERF_MODEL_OWN_THREAD
-      m_instruction_queue.push_wait(ins);
-   #else
-      m_instruction_queue.push(ins);
-   #endif
+   m_instruction_queue.push(ins);
 }
 
 void PerformanceModel::handleIdleInstruction(PseudoInstruction *instruction)
@@ -291,29 +306,95 @@ void PerformanceModel::handleIdleInstruction(PseudoInstruction *instruction)
       m_fastforward_model->notifyElapsedTimeUpdate();
 }
 
+void PerformanceModel::handleQueuedInstruction(DynamicInstruction *ins)
+{
+   LOG_ASSERT_ERROR(!ins->instruction->isIdle(), "Idle instructions should not make it here!");
+
+   if (!m_fastforward && m_enabled)
+      handleInstruction(ins);
+
+   delete ins;
+}
+
 void PerformanceModel::iterate()
 {
+#ifdef ENABLE_PERF_MODEL_OWN_THREAD
+   // Instructions are simulated by the core thread, the queue hands them over in batches as they are pushed
+#else
    while (m_instruction_queue.size() > 0)
    {
-      // While the functional thread is waiting because of clock skew minimization, wait here as well
-      #ifdef ENABLE_PERF_MODEL_OWN_THREAD
-      while(m_hold)
-         sched_yield();
-      #endif
+      handleQueuedInstruction(m_instruction_queue.front());
+      m_instruction_queue.pop();
+   }
 
-      DynamicInstruction *ins = m_instruction_queue.front();
+   synchronize();
+#endif
+}
 
-      LOG_ASSERT_ERROR(!ins->instruction->isIdle(), "Idle instructions should not make it here!");
+void PerformanceModel::run()
+{
+#ifdef ENABLE_PERF_MODEL_OWN_THREAD
+   while (true)
+   {
+      handlePseudoInstructions();
+      if (!m_instruction_queue.empty())
+      {
+         handleQueuedInstruction(m_instruction_queue.front());
+         // Synchronize before releasing the slot: while we are held in the clock skew barrier,
+         // the front end can only run ahead until the queue is full.
+         synchronize();
+         m_instruction_queue.pop();
+      }
+      else if (!m_instruction_queue.wait())
+         break;
+   }
+#else
+   LOG_PRINT_ERROR("The performance model does not have its own thread, instructions are simulated by iterate()");
+#endif
+}
 
-      if (!m_fastforward && m_enabled)
-         handleInstruction(ins);
+#ifdef ENABLE_PERF_MODEL_OWN_THREAD
+void PerformanceModel::handlePseudoInstructions()
+{
+   while (m_pseudo_pending)
+   {
+      DynamicInstruction *ins;
+      {
+         ScopedLock sl(m_pseudo_lock);
+         ins = m_pseudo_queue.front();
+         m_pseudo_queue.pop();
+         m_pseudo_pending = !m_pseudo_queue.empty();
+      }
+      // Not holding the lock, simulating the instruction may queue more pseudo instructions (TLB misses)
+      handleQueuedInstruction(ins);
+   }
+}
+#endif
 
-      delete ins;
+// True when called by the front end of the thread running on this core, the only thread that may push into
+// m_instruction_queue with ENABLE_PERF_MODEL_OWN_THREAD, or wait for it to be drained
+bool PerformanceModel::isFrontEndThread()
+{
+   return Sim()->getCoreManager()->getCurrentCore() == m_core && !Sim()->getCoreManager()->amiCoreThread();
+}
 
-      m_instruction_queue.pop();
-   }
+void PerformanceModel::stop()
+{
+#ifdef ENABLE_PERF_MODEL_OWN_THREAD
+   m_instruction_queue.interrupt();
+#endif
+}
 
-   synchronize();
+// Wait until all queued instructions have been simulated. Called from the front end before it reads or updates
+// this core's time or state. No-op unless the performance model runs on its own thread.
+void PerformanceModel::drain()
+{
+#ifdef ENABLE_PERF_MODEL_OWN_THREAD
+   // Only our own front end may wait for the core thread: it can be blocked in the clock skew barrier,
+   // waiting for other cores to advance, which would deadlock if their threads are waiting here.
+   if (isFrontEndThread())
+      m_instruction_queue.flush();
+#endif
 }
 
 void PerformanceModel::synchronize()
@@ -3,13 +3,15 @@
 // This class represents the actual performance model for a given core
 
 #include "fixed_types.h"
-#include "mt_circular_queue.h"
+#include "circular_queue.h"
+#include "spsc_queue.h"
 #include "lock.h"
 #include "subsecond_time.h"
 #include "instruction_tracer.h"
 #include "hit_where.h"
 
 #include <queue>
+#include <vector>
 #include <iostream>
 
 // Forward Decls
@@ -32,6 +34,11 @@ public:
    void handleIdleInstruction(PseudoInstruction *i);
    void iterate();
    virtual void synchronize();
+   void drain();
+
+   // Core thread (ENABLE_PERF_MODEL_OWN_THREAD): simulate instructions as the front end queues them, until stop() is called
+   void run();
+   void stop();
 
    UInt64 getInstructionCount() const { return m_instruction_count; }
 
@@ -64,7 +71,6 @@ public:
    void disable();
    void enable();
    bool isEnabled() { return m_enabled; }
-   void setHold(bool hold) { m_hold = hold; }
 
    bool isFastForward() { return m_fastforward; }
    void setFastForward(bool fastforward, bool detailed_sync = true)
@@ -92,7 +98,7 @@ protected:
    void incrementIdleElapsedTime(SubsecondTime time);
 
    #ifdef ENABLE_PERF_MODEL_OWN_THREAD
-      typedef MTCircularQueue<DynamicInstruction*> InstructionQueue;
+      typedef SPSCQueue<DynamicInstruction*> InstructionQueue;
    #else
       typedef CircularQueue<DynamicInstruction*> InstructionQueue;
    #endif
@@ -112,7 +118,10 @@ private:
    virtual void disableDetailedModel() {}
 
    Core* m_core;
-   Allocator *m_dynins_alloc;
+   // DynamicInstructions created by the front end running on this core, by number of memory operands
+   std::vector<Allocator*> m_dynins_alloc;
+   // Pseudo instructions, which can be queued by any thread
+   Allocator *m_pseudo_dynins_alloc;
 
    bool m_enabled;
 
@@ -120,8 +129,6 @@ private:
    FastforwardPerformanceModel* m_fastforward_model;
    bool m_detailed_sync;
 
-   bool m_hold;
-
 protected:
    UInt64 m_instruction_count;
 
@@ -145,6 +152,19 @@ private:
 
    InstructionQueue m_instruction_queue;
 
+   #ifdef ENABLE_PERF_MODEL_OWN_THREAD
+   // Pseudo instructions queued by threads other than our front end (the core thread itself on a TLB miss,
+   // sim threads receiving packets, DVFS changes). They cannot be pushed into the single-producer
+   // m_instruction_queue, the core thread handles them in between instructions.
+   Lock m_pseudo_lock;
+   std::queue<DynamicInstruction*> m_pseudo_queue;
+   volatile bool m_pseudo_pending;
+   void handlePseudoInstructions();
+   #endif
+
+   bool isFrontEndThread();
+   void handleQueuedInstruction(DynamicInstruction *ins);
+
    UInt32 m_current_ins_index;
 
    BranchPredictor *m_bp;
@@ -19,6 +19,9 @@ class CoreModel
    private:
       static std::map<String, const CoreModel*> s_core_models;
 
+   protected:
+      Allocator *m_template_allocator;
+
    public:
       static const CoreModel* getCoreModel(String type);
 
@@ -32,6 +35,10 @@ class CoreModel
 
       // Populate a MicroOp's core-specific information object
       virtual DynamicMicroOp* createDynamicMicroOp(Allocator *alloc, const MicroOp *uop, ComponentPeriod period) const = 0;
+      // Copy a DynamicMicroOp created by createDynamicMicroOp
+      virtual DynamicMicroOp* cloneDynamicMicroOp(Allocator *alloc, const DynamicMicroOp *uop, ComponentPeriod period) const = 0;
+      // Allocator for the prototype DynamicMicroOps of MicroOpTemplates, which live as long as their Instruction
+      Allocator* getTemplateAllocator() const { return m_template_allocator; }
 
       virtual unsigned int getInstructionLatency(const MicroOp *uop) const = 0;
       virtual unsigned int getAluLatency(const MicroOp *uop) const = 0;
@@ -42,6 +49,11 @@ class CoreModel
 template <typename T> class BaseCoreModel : public CoreModel
 {
    public:
+      BaseCoreModel()
+      {
+         m_template_allocator = new TypedAllocator<T>();
+      }
+
       virtual Allocator* createDMOAllocator() const
       {
          // We need to be able to hold one (Pin) trace worth of MicroOps, as we can only stop functional simulation at the skew barrier
@@ -53,6 +65,12 @@ template <typename T> class BaseCoreModel : public CoreModel
          T *info = DynamicMicroOp::alloc<T>(alloc, uop, this, period);
          return info;
       }
+
+      DynamicMicroOp* cloneDynamicMicroOp(Allocator *alloc, const DynamicMicroOp *uop, ComponentPeriod period) const
+      {
+         T *info = DynamicMicroOp::clone<T>(alloc, static_cast<const T*>(uop), period);
+         return info;
+      }
 };
 
 #endif // __CORE_MODEL
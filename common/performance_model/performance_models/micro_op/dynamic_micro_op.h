@@ -18,7 +18,7 @@ class DynamicMicroOp
       const CoreModel *m_core_model;
 
       // architecture-independent information
-      const SubsecondTime m_period;
+      SubsecondTime m_period;
 
       /** The sequence number of the microOperation. Unique (per thread) ! */
       uint64_t sequenceNumber;
@@ -77,6 +77,14 @@ class DynamicMicroOp
          T *t = new(ptr) T(uop, core_model, period);
          return t;
       }
+      // Copy of a prototype (see MicroOpTemplate), running at period
+      template<typename T> static T* clone(Allocator *alloc, const T *uop, ComponentPeriod period)
+      {
+         void *ptr = alloc->alloc(sizeof(T));
+         T *t = new(ptr) T(*uop);
+         static_cast<DynamicMicroOp*>(t)->m_period = period;
+         return t;
+      }
       static void operator delete(void* ptr) { Allocator::dealloc(ptr); }
 
       const MicroOp *getMicroOp() const { return m_uop; }
@@ -0,0 +1,51 @@
+#include "micro_op_template.h"
+#include "instruction.h"
+#include "core_model.h"
+#include "dynamic_micro_op.h"
+#include "micro_op.h"
+
+#include <stdint.h>
+
+MicroOpTemplate::MicroOpTemplate(const Instruction *instruction, const CoreModel *core_model)
+   : core_model(core_model)
+   , next(NULL)
+   , exec_base_index(SIZE_MAX)
+   , load_base_index(SIZE_MAX)
+   , store_base_index(SIZE_MAX)
+   , num_loads(0)
+   , num_stores(0)
+{
+   const std::vector<const MicroOp*> *microops = instruction->getMicroOps();
+   // The period is set on each copy, any valid one will do here
+   ComponentPeriod period = ComponentPeriod::fromFreqHz(1000000000);
+
+   for(size_t m = 0; m < microops->size(); ++m)
+   {
+      const MicroOp *uop = (*microops)[m];
+      uops.push_back(core_model->createDynamicMicroOp(core_model->getTemplateAllocator(), uop, period));
+
+      if (uop->isExecute())
+      {
+         exec_base_index = m;
+      }
+      if (uop->isStore())
+      {
+         ++num_stores;
+         if (store_base_index == SIZE_MAX)
+            store_base_index = m;
+      }
+      if (uop->isLoad())
+      {
+         ++num_loads;
+         if (load_base_index == SIZE_MAX)
+            load_base_index = m;
+      }
+   }
+}
+
+MicroOpTemplate::~MicroOpTemplate()
+{
+   for(std::vector<DynamicMicroOp*>::iterator it = uops.begin(); it != uops.end(); ++it)
+      delete *it;
+   delete next;
+}
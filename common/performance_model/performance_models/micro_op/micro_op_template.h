@@ -0,0 +1,36 @@
+#ifndef __MICRO_OP_TEMPLATE_H
+#define __MICRO_OP_TEMPLATE_H
+
+#include "fixed_types.h"
+
+#include <vector>
+
+class Instruction;
+class CoreModel;
+class DynamicMicroOp;
+
+// Everything MicroOpPerformanceModel::handleInstruction needs to know about a static instruction,
+// computed the first time the instruction is simulated on a given core model.
+// The prototypes have their core-specific properties (latency, port, bypass and ALU class) filled in,
+// dynamic micro-ops are copies of them (see CoreModel::cloneDynamicMicroOp).
+// Templates are immutable once built, and owned by their Instruction.
+class MicroOpTemplate
+{
+   public:
+      MicroOpTemplate(const Instruction *instruction, const CoreModel *core_model);
+      ~MicroOpTemplate();
+
+      const CoreModel* const core_model;
+      // Template for the same instruction on another core model
+      MicroOpTemplate *next;
+
+      std::vector<DynamicMicroOp*> uops;
+      // Index of the last execute micro-op, the first load and the first store (SIZE_MAX if there are none)
+      size_t exec_base_index;
+      size_t load_base_index;
+      size_t store_base_index;
+      size_t num_loads;
+      size_t num_stores;
+};
+
+#endif // __MICRO_OP_TEMPLATE_H
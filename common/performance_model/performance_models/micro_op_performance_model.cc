@@ -11,6 +11,7 @@
 #include "allocator.h"
 #include "config.hpp"
 #include "dynamic_instruction.h"
+#include "micro_op_template.h"
 
 #include <cstdio>
 #include <algorithm>
@@ -150,6 +151,19 @@ void MicroOpPerformanceModel::doSquashing(std::vector<DynamicMicroOp*> &current_
    }
 }
 
+const MicroOpTemplate* MicroOpPerformanceModel::getMicroOpTemplate(const Instruction *instruction)
+{
+   for(const MicroOpTemplate *uop_template = instruction->getMicroOpTemplates(); uop_template; uop_template = uop_template->next)
+      if (uop_template->core_model == m_core_model)
+         return uop_template;
+
+   // First time this instruction is simulated on our core model.
+   // If another thread does the same concurrently, both templates are kept, either one is fine to use.
+   MicroOpTemplate *uop_template = new MicroOpTemplate(instruction, m_core_model);
+   instruction->addMicroOpTemplate(uop_template);
+   return uop_template;
+}
+
 void MicroOpPerformanceModel::handleInstruction(DynamicInstruction *dynins)
 {
    ComponentPeriod insn_period = *(const_cast<ComponentPeriod*>(static_cast<const ComponentPeriod*>(m_elapsed_time)));
@@ -165,15 +179,6 @@ void MicroOpPerformanceModel::handleInstruction(DynamicInstruction *dynins)
    UInt64 num_writes_done = 0;
    UInt64 num_nonmem_done = 0;
 
-   if (dynins->instruction->getMicroOps())
-   {
-      for(std::vector<const MicroOp*>::const_iterator it = dynins->instruction->getMicroOps()->begin(); it != dynins->instruction->getMicroOps()->end(); it++)
-      {
-         m_current_uops.push_back(m_core_model->createDynamicMicroOp(m_allocator, *it, insn_period));
-      }
-   }
-
-   // Find some information
    size_t num_loads = 0;
    size_t num_stores = 0;
    size_t exec_base_index = SIZE_MAX;
@@ -181,24 +186,22 @@ void MicroOpPerformanceModel::handleInstruction(DynamicInstruction *dynins)
    size_t load_base_index = SIZE_MAX;
    // Find the first store
    size_t store_base_index = SIZE_MAX;
-   for (size_t m = 0 ; m < m_current_uops.size() ; m++ )
+
+   if (dynins->instruction->getMicroOps())
    {
-      if (m_current_uops[m]->getMicroOp()->isExecute())
-      {
-         exec_base_index = m;
-      }
-      if (m_current_uops[m]->getMicroOp()->isStore())
-      {
-         ++num_stores;
-         if (store_base_index == SIZE_MAX)
-            store_base_index = m;
-      }
-      if (m_current_uops[m]->getMicroOp()->isLoad())
+      // Copy the dynamic micro-ops from the instruction's template, which also knows where its loads and stores are
+      const MicroOpTemplate *uop_template = getMicroOpTemplate(dynins->instruction);
+
+      for(std::vector<DynamicMicroOp*>::const_iterator it = uop_template->uops.begin(); it != uop_template->uops.end(); it++)
       {
-         ++num_loads;
-         if (load_base_index == SIZE_MAX)
-            load_base_index = m;
+         m_current_uops.push_back(m_core_model->cloneDynamicMicroOp(m_allocator, *it, insn_period));
       }
+
+      num_loads = uop_template->num_loads;
+      num_stores = uop_template->num_stores;
+      exec_base_index = uop_template->exec_base_index;
+      load_base_index = uop_template->load_base_index;
+      store_base_index = uop_template->store_base_index;
    }
 
    // Compute the iCache cost, and add to our cycle time
@@ -235,7 +238,7 @@ void MicroOpPerformanceModel::handleInstruction(DynamicInstruction *dynins)
       if (o.m_type == Operand::MEMORY)
       {
          LOG_ASSERT_ERROR(dynins->num_memory > memidx, "Did not get enough memory_info objects");
-         DynamicInstruction::MemoryInfo &info = dynins->memory_info[memidx++];
+         DynamicInstruction::MemoryInfo &info = dynins->getMemoryInfo(memidx++);
          LOG_ASSERT_ERROR(info.dir == o.m_direction,
                           "Expected memory %d info, got: %d.", o.m_direction, info.dir);
 
@@ -263,12 +266,16 @@ void MicroOpPerformanceModel::handleInstruction(DynamicInstruction *dynins)
                LOG_ASSERT_ERROR(m_current_uops[load_index]->getMicroOp()->isLoad(),
                                 "Expected uop %d to be a load.", load_index);
 
-               if (std::find(m_cache_lines_read.begin(), m_cache_lines_read.end(), cache_line) != m_cache_lines_read.end())
+               // Only instructions with multiple loads can touch the same cache line twice
+               if (num_loads > 1)
                {
-                  m_current_uops[load_index]->squash(&m_current_uops);
-                  do_squashing = true;
+                  if (std::find(m_cache_lines_read.begin(), m_cache_lines_read.end(), cache_line) != m_cache_lines_read.end())
+                  {
+                     m_current_uops[load_index]->squash(&m_current_uops);
+                     do_squashing = true;
+                  }
+                  m_cache_lines_read.push_back(cache_line);
                }
-               m_cache_lines_read.push_back(cache_line);
 
                // Update this uop with load latencies
                UInt64 bypass_latency = m_core_model->getBypassLatency(m_current_uops[load_index]);
@@ -298,12 +305,15 @@ void MicroOpPerformanceModel::handleInstruction(DynamicInstruction *dynins)
                LOG_ASSERT_ERROR(m_current_uops[store_index]->getMicroOp()->isStore(),
                                 "Expected uop %d to be a store. [%d|%s]", store_index, m_current_uops[store_index]->getMicroOp()->getType(), m_current_uops[store_index]->getMicroOp()->toString().c_str());
 
-               if (std::find(m_cache_lines_written.begin(), m_cache_lines_written.end(), cache_line) != m_cache_lines_written.end())
+               if (num_stores > 1)
                {
-                  m_current_uops[store_index]->squash(&m_current_uops);
-                  do_squashing = true;
+                  if (std::find(m_cache_lines_written.begin(), m_cache_lines_written.end(), cache_line) != m_cache_lines_written.end())
+                  {
+                     m_current_uops[store_index]->squash(&m_current_uops);
+                     do_squashing = true;
+                  }
+                  m_cache_lines_written.push_back(cache_line);
                }
-               m_cache_lines_written.push_back(cache_line);
 
                // Update this uop with store latencies.
                UInt64 bypass_latency = m_core_model->getBypassLatency(m_current_uops[store_index]);
@@ -346,8 +356,8 @@ void MicroOpPerformanceModel::handleInstruction(DynamicInstruction *dynins)
       // Set whether the branch was mispredicted or not
       LOG_ASSERT_ERROR(m_current_uops[exec_base_index]->getMicroOp()->isBranch(), "Expected to find a branch here.");
       m_current_uops[exec_base_index]->setBranchMispredicted(is_mispredict);
-      m_current_uops[exec_base_index]->setBranchTaken(dynins->branch_info.taken);
-      m_current_uops[exec_base_index]->setBranchTarget(dynins->branch_info.target);
+      m_current_uops[exec_base_index]->setBranchTaken(dynins->branch_taken);
+      m_current_uops[exec_base_index]->setBranchTarget(dynins->branch_target);
       // Do not update the execution latency of a branch instruction
       // The interval model will calculate the branch latency
    }
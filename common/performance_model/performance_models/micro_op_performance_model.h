@@ -14,6 +14,7 @@
 
 class CoreModel;
 class Allocator;
+class MicroOpTemplate;
 
 class MicroOpPerformanceModel : public PerformanceModel
 {
@@ -30,6 +31,7 @@ protected:
 
 private:
    void handleInstruction(DynamicInstruction *instruction);
+   const MicroOpTemplate* getMicroOpTemplate(const Instruction *instruction);
 
    static MicroOp* m_serialize_uop;
    static MicroOp* m_mfence_uop;
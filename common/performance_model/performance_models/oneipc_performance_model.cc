@@ -53,7 +53,7 @@ void OneIPCPerformanceModel::handleInstruction(DynamicInstruction *dynins)
       if (o.m_type == Operand::MEMORY)
       {
          LOG_ASSERT_ERROR(dynins->num_memory > memidx, "Did not get enough memory_info objects");
-         DynamicInstruction::MemoryInfo &info = dynins->memory_info[memidx++];
+         DynamicInstruction::MemoryInfo &info = dynins->getMemoryInfo(memidx++);
          LOG_ASSERT_ERROR(info.dir == o.m_direction,
                           "Expected memory %d info, got: %d.", o.m_direction, info.dir);
 
@@ -17,6 +17,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 // Define to get per-cycle printout of dispatch, issue, writeback stages
 //#define DEBUG_PERCYCLE
@@ -181,6 +182,7 @@ RobTimer::~RobTimer()
 
 void RobTimer::RobEntry::init(DynamicMicroOp *_uop, UInt64 sequenceNumber)
 {
+   dispatched = SubsecondTime::MaxTime();
    ready = SubsecondTime::MaxTime();
    readyMax = SubsecondTime::Zero();
    addressReady = SubsecondTime::MaxTime();
@@ -250,6 +252,43 @@ RobTimer::RobEntry *RobTimer::findEntryBySequenceNumber(UInt64 sequenceNumber)
    return entry;
 }
 
+void RobTimer::schedule(ScheduleQueue &queue, RobEntry *entry, SubsecondTime time)
+{
+   ScheduledEntry e = { time, entry->uop->getSequenceNumber(), entry };
+   queue.push(e);
+}
+
+SubsecondTime RobTimer::getNextReady()
+{
+   // Earliest ready time of all uops waiting in the reservation stations, uops that have issued are dropped.
+   // Entries still in the ROB are at their original position, entries older than the ROB head have issued too.
+   UInt64 first = rob.size() ? rob.front().uop->getSequenceNumber() : nextSequenceNumber;
+   while(!m_ready_queue.empty()
+         && (m_ready_queue.top().sequenceNumber < first || m_ready_queue.top().entry->done != SubsecondTime::MaxTime()))
+      m_ready_queue.pop();
+
+   return m_ready_queue.empty() ? SubsecondTime::MaxTime() : m_ready_queue.top().time;
+}
+
+SubsecondTime RobTimer::getNextDone(UInt64 beforeSequenceNumber)
+{
+   // Earliest completion time of all issued uops older than beforeSequenceNumber that have not yet committed
+   UInt64 first = rob.size() ? rob.front().uop->getSequenceNumber() : nextSequenceNumber;
+   while(!m_done_queue.empty() && m_done_queue.top().sequenceNumber < first)
+      m_done_queue.pop();
+
+   if (m_done_queue.empty())
+      return SubsecondTime::MaxTime();
+   else if (m_done_queue.top().sequenceNumber < beforeSequenceNumber)
+      return m_done_queue.top().time;
+
+   // The earliest completing uop is too young, walk the older part of the ROB
+   SubsecondTime next_done = SubsecondTime::MaxTime();
+   for(uint64_t i = 0; i < m_num_in_rob && rob.at(i).uop->getSequenceNumber() < beforeSequenceNumber; ++i)
+      next_done = std::min(next_done, rob.at(i).done);
+   return next_done;
+}
+
 boost::tuple<uint64_t,SubsecondTime> RobTimer::simulate(const std::vector<DynamicMicroOp*>& insts)
 {
    uint64_t totalInsnExec = 0;
@@ -494,6 +533,7 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
          entry->dispatched = now;
          ++m_num_in_rob;
          ++m_rs_entries_used;
+         m_rs.push_back(entry);
 
          uops_dispatched++;
          if (uop.isLast())
@@ -502,6 +542,8 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
          // If uop is already ready, we may need to issue it in the following cycle
          entry->ready = std::max(entry->ready, (now + 1ul).getElapsedTime());
          next_event = std::min(next_event, entry->ready);
+         if (entry->ready != SubsecondTime::MaxTime())
+            schedule(m_ready_queue, entry, entry->ready);
 
          #ifdef DEBUG_PERCYCLE
             std::cout<<"DISPATCH "<<entry->uop->getMicroOp()->toShortString()<<std::endl;
@@ -564,9 +606,8 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
       return std::min(frontend_stalled_until, next_event);
 }
 
-void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
+void RobTimer::issueInstruction(RobEntry *entry, SubsecondTime &next_event)
 {
-   RobEntry *entry = &rob[idx];
    DynamicMicroOp &uop = *entry->uop;
 
    if ((uop.getMicroOp()->isLoad() || uop.getMicroOp()->isStore())
@@ -629,6 +670,7 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
    entry->issued = now;
    entry->done = cycle_done;
    next_event = std::min(next_event, entry->done);
+   schedule(m_done_queue, entry, entry->done);
 
    --m_rs_entries_used;
 
@@ -650,6 +692,9 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
       {
          depEntry->ready = depEntry->readyMax;
          //std::cout<<"    ready @ "<<depEntry->ready<<std::endl;
+         // Uops that are not yet dispatched are scheduled when they enter the reservation stations
+         if (depEntry->dispatched != SubsecondTime::MaxTime())
+            schedule(m_ready_queue, depEntry, depEntry->ready);
       }
 
       // For stores, check if their address has been produced
@@ -703,17 +748,26 @@ SubsecondTime RobTimer::doIssue()
    if (m_rob_contention)
       m_rob_contention->initCycle(now);
 
-   for(uint64_t i = 0; i < m_num_in_rob; ++i)
+   // Every check below requires a uop to be ready, so when none are nothing can issue this cycle.
+   // The only thing left to do is to find the next event, which is what walking the ROB would have found.
+   SubsecondTime next_ready = getNextReady();
+   if (next_ready > now)
    {
-      RobEntry *entry = &rob.at(i);
-      DynamicMicroOp *uop = entry->uop;
+      if (inorder && m_rs.size())
+         // In-order: the walk stops at the first waiting uop
+         return std::min(m_rs.front()->ready, getNextDone(m_rs.front()->uop->getSequenceNumber()));
+      else
+         return std::min(next_ready, getNextDone(UINT64_MAX));
+   }
 
+   // Walk the waiting uops in program order. Uops that were issued before are skipped over, they don't
+   // affect issue decisions, only the next event time (for those older than the point where the walk stops).
+   UInt64 stop_before = UINT64_MAX;
 
-      if (entry->done != SubsecondTime::MaxTime())
-      {
-         next_event = std::min(next_event, entry->done);
-         continue;                     // already done
-      }
+   for(uint64_t i = 0; i < m_rs.size(); ++i)
+   {
+      RobEntry *entry = m_rs[i];
+      DynamicMicroOp *uop = entry->uop;
 
       next_event = std::min(next_event, entry->ready);
 
@@ -733,7 +787,10 @@ SubsecondTime RobTimer::doIssue()
          if (head_of_queue && last_store_done <= now)
             canIssue = true;
          else
+         {
+            stop_before = uop->getSequenceNumber();
             break;
+         }
       }
 
       else if (uop->getMicroOp()->isMemBarrier())
@@ -770,7 +827,7 @@ SubsecondTime RobTimer::doIssue()
       if (canIssue)
       {
          num_issued++;
-         issueInstruction(i, next_event);
+         issueInstruction(entry, next_event);
 
          // Calculate memory-level parallelism (MLP) for long-latency loads (but ignore overlapped misses)
          if (uop->getMicroOp()->isLoad() && uop->isLongLatencyLoad() && uop->getDCacheHitWhere() != HitWhere::L1_OWN)
@@ -808,24 +865,25 @@ SubsecondTime RobTimer::doIssue()
             have_unresolved_store = true;
 
          if (inorder)
+         {
             // In-order: only issue from head of the ROB
+            stop_before = uop->getSequenceNumber();
             break;
+         }
       }
 
 
-      if (m_rob_contention)
+      if (m_rob_contention ? m_rob_contention->noMore() : num_issued == dispatchWidth)
       {
-         if (m_rob_contention->noMore())
-            break;
-      }
-      else
-      {
-         if (num_issued == dispatchWidth)
-            break;
+         stop_before = uop->getSequenceNumber() + 1;
+         break;
       }
    }
 
-   return next_event;
+   if (num_issued)
+      m_rs.erase(std::remove_if(m_rs.begin(), m_rs.end(), isIssued), m_rs.end());
+
+   return std::min(next_event, getNextDone(stop_before));
 }
 
 SubsecondTime RobTimer::doCommit(uint64_t& instructionsExecuted)
@@ -10,6 +10,7 @@
 #include "stats.h"
 
 #include <deque>
+#include <queue>
 
 class RobTimer
 {
@@ -60,6 +61,24 @@ private:
    Rob rob;
    uint64_t m_num_in_rob;
    uint64_t m_rs_entries_used;
+
+   // Issue scheduling. Rather than walking the whole ROB every cycle, doIssue() only visits the uops that
+   // are waiting in the reservation stations (m_rs, in program order), and only when at least one of them
+   // is ready: min-heaps of the ready times of waiting uops and the completion times of issued uops
+   // provide the next event time otherwise. Heap entries are removed lazily once their uop has issued
+   // (m_ready_queue) or committed (m_done_queue).
+   struct ScheduledEntry
+   {
+      SubsecondTime time;
+      UInt64 sequenceNumber;
+      RobEntry *entry;
+      bool operator>(const ScheduledEntry &other) const { return time > other.time; }
+   };
+   typedef std::priority_queue<ScheduledEntry, std::vector<ScheduledEntry>, std::greater<ScheduledEntry> > ScheduleQueue;
+   std::vector<RobEntry*> m_rs;
+   ScheduleQueue m_ready_queue;
+   ScheduleQueue m_done_queue;
+
    RobContention *m_rob_contention;
 
    ComponentTime now;
@@ -136,6 +155,10 @@ private:
    std::vector<SubsecondTime> m_outstandingLoadsAll;
 
    RobEntry *findEntryBySequenceNumber(UInt64 sequenceNumber);
+   void schedule(ScheduleQueue &queue, RobEntry *entry, SubsecondTime time);
+   SubsecondTime getNextReady();
+   SubsecondTime getNextDone(UInt64 beforeSequenceNumber);
+   static bool isIssued(const RobEntry *entry) { return entry->done != SubsecondTime::MaxTime(); }
    SubsecondTime* findCpiComponent();
    void countOutstandingMemop(SubsecondTime time);
    void printRob();
@@ -145,7 +168,7 @@ private:
    SubsecondTime doIssue();
    SubsecondTime doCommit(uint64_t& instructionsExecuted);
 
-   void issueInstruction(uint64_t idx, SubsecondTime &next_event);
+   void issueInstruction(RobEntry *entry, SubsecondTime &next_event);
 
 public:
 
@@ -0,0 +1,195 @@
+#include "queue_model_history_flat.h"
+#include "simulator.h"
+#include "config.h"
+#include "log.h"
+#include "stats.h"
+#include "config.hpp"
+
+#include <algorithm>
+
+QueueModelHistoryFlat::QueueModelHistoryFlat(String name, UInt32 id, SubsecondTime min_processing_time):
+   m_min_processing_time(min_processing_time),
+   m_first(0),
+   m_last(0),
+   m_utilized_time(SubsecondTime::Zero()),
+   m_total_queue_delay(SubsecondTime::Zero()),
+   m_total_requests(0),
+   m_total_requests_using_analytical_model(0)
+{
+   UInt32 max_list_size = 0;
+   try
+   {
+      m_analytical_model_enabled = Sim()->getCfg()->getBool("queue_model/history_flat/analytical_model_enabled");
+      max_list_size = Sim()->getCfg()->getInt("queue_model/history_flat/max_list_size");
+   }
+   catch(...)
+   {
+      LOG_PRINT_ERROR("Could not read parameters from cfg");
+   }
+   LOG_ASSERT_ERROR(max_list_size > 0, "queue_model/history_flat/max_list_size must be at least 1");
+   m_max_free_interval_list_size = max_list_size;
+   m_average_delay = MovingAverage<SubsecondTime>::createAvgType(MovingAverage<SubsecondTime>::ARITHMETIC_MEAN, max_list_size);
+
+   // The list holds up to max_list_size + 1 intervals before the oldest one is dropped,
+   // the remainder of the array is room to insert intervals before having to move the list back to the front
+   m_intervals.resize(2 * (max_list_size + 1));
+   Interval all_time = { SubsecondTime::Zero(), SubsecondTime::FS() << 63 };
+   m_intervals[m_last++] = all_time;
+
+   registerStatsMetric(name, id, "num-requests", &m_total_requests);
+   registerStatsMetric(name, id, "num-requests-analytical", &m_total_requests_using_analytical_model);
+   registerStatsMetric(name, id, "total-time-used", &m_utilized_time);
+   registerStatsMetric(name, id, "total-queue-delay", &m_total_queue_delay);
+}
+
+QueueModelHistoryFlat::~QueueModelHistoryFlat()
+{
+   delete m_average_delay;
+}
+
+SubsecondTime
+QueueModelHistoryFlat::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester)
+{
+   LOG_ASSERT_ERROR(m_last > m_first, "Free Interval list size < 1");
+
+   SubsecondTime queue_delay;
+
+   // Old packets, which end before the oldest free interval we still know about, use the analytical model
+   if (m_analytical_model_enabled && ((pkt_time + processing_time) <= m_intervals[m_first].start))
+   {
+      m_total_requests_using_analytical_model ++;
+      queue_delay = computeUsingAnalyticalModel(pkt_time, processing_time);
+   }
+   else
+   {
+      queue_delay = computeUsingHistoryList(pkt_time, processing_time);
+      m_average_delay->update(queue_delay);
+   }
+
+   m_utilized_time += processing_time;
+
+   m_total_requests ++;
+   m_total_queue_delay += queue_delay;
+
+   return queue_delay;
+}
+
+float
+QueueModelHistoryFlat::getQueueUtilization()
+{
+   SubsecondTime total_time = m_intervals[m_last - 1].start;
+
+   if (total_time == SubsecondTime::Zero())
+   {
+      LOG_ASSERT_ERROR(m_utilized_time == SubsecondTime::Zero(), "m_utilized_time(%s), total_time(%s)",
+            itostr(m_utilized_time).c_str(), itostr(total_time).c_str());
+      return 0;
+   }
+   else
+   {
+      return ((float) m_utilized_time.getInternalDataForced() / total_time.getInternalDataForced());
+   }
+}
+
+float
+QueueModelHistoryFlat::getFracRequestsUsingAnalyticalModel()
+{
+  if (m_total_requests == 0)
+     return 0;
+  else
+     return ((float) m_total_requests_using_analytical_model / m_total_requests);
+}
+
+SubsecondTime
+QueueModelHistoryFlat::computeUsingAnalyticalModel(SubsecondTime pkt_time, SubsecondTime processing_time)
+{
+   // Same as QueueModelHistoryList: return the average of the delays computed using the history list
+   return m_average_delay->compute();
+}
+
+void
+QueueModelHistoryFlat::replaceInterval(UInt32 index, const Interval *intervals, UInt32 count)
+{
+   // Replace the interval at index by count (0, 1 or 2) new ones
+   if (count == 2)
+   {
+      if (m_last == m_intervals.size())
+      {
+         // Out of room at the end, move the list back to the front of the array
+         std::copy(m_intervals.begin() + m_first, m_intervals.begin() + m_last, m_intervals.begin());
+         index -= m_first;
+         m_last -= m_first;
+         m_first = 0;
+      }
+      std::copy_backward(m_intervals.begin() + index + 1, m_intervals.begin() + m_last, m_intervals.begin() + m_last + 1);
+      ++m_last;
+   }
+   else if (count == 0)
+   {
+      std::copy(m_intervals.begin() + index + 1, m_intervals.begin() + m_last, m_intervals.begin() + index);
+      --m_last;
+   }
+   std::copy(intervals, intervals + count, m_intervals.begin() + index);
+}
+
+SubsecondTime
+QueueModelHistoryFlat::computeUsingHistoryList(SubsecondTime pkt_time, SubsecondTime processing_time)
+{
+   LOG_ASSERT_ERROR(m_last - m_first <= m_max_free_interval_list_size,
+         "Free Interval list size(%u) > %u", m_last - m_first, m_max_free_interval_list_size);
+
+   std::vector<Interval>::iterator begin = m_intervals.begin() + m_first, end = m_intervals.begin() + m_last;
+   // The first interval that is still free when the request completes, and the first one that starts after the request arrives.
+   // All intervals before the latter start no later than pkt_time, so if the former comes before it, the request fits there.
+   // Otherwise, none of the intervals starting before pkt_time fit, and the request is delayed until the next free interval.
+   // This is the interval the linear walk of QueueModelHistoryList finds.
+   UInt32 fits = std::lower_bound(begin, end, pkt_time + processing_time, endsBefore) - m_intervals.begin();
+   UInt32 after = std::upper_bound(begin, end, pkt_time, startsAfter) - m_intervals.begin();
+
+   SubsecondTime queue_delay;
+   Interval remaining[2];
+   UInt32 num_remaining = 0;
+
+   if (fits < after)
+   {
+      Interval interval = m_intervals[fits];
+      queue_delay = SubsecondTime::Zero();
+      if ((pkt_time - interval.start) >= m_min_processing_time)
+      {
+         Interval before = { interval.start, pkt_time };
+         remaining[num_remaining++] = before;
+      }
+      if ((interval.end - (pkt_time + processing_time)) >= m_min_processing_time)
+      {
+         Interval behind = { pkt_time + processing_time, interval.end };
+         remaining[num_remaining++] = behind;
+      }
+      replaceInterval(fits, remaining, num_remaining);
+   }
+   else
+   {
+      LOG_ASSERT_ERROR(after < m_last, "pkt_time(%s), free interval not found", itostr(pkt_time).c_str());
+
+      // The request comes before this free interval (but may not fit in it, see QueueModelHistoryList)
+      Interval interval = m_intervals[after];
+      queue_delay = interval.start - pkt_time;
+      // Unlike QueueModelHistoryList, drop the interval completely when the request does not fit,
+      // rather than keeping an interval that ends before it starts
+      if (interval.end >= interval.start + processing_time
+          && (interval.end - (interval.start + processing_time)) >= m_min_processing_time)
+      {
+         Interval behind = { interval.start + processing_time, interval.end };
+         remaining[num_remaining++] = behind;
+      }
+      replaceInterval(after, remaining, num_remaining);
+   }
+
+   if (m_last - m_first > m_max_free_interval_list_size)
+   {
+      ++m_first;
+   }
+
+   LOG_PRINT("HistoryFlat: pkt_time(%s), processing_time(%s), queue_delay(%s)", itostr(pkt_time).c_str(), itostr(processing_time).c_str(), itostr(queue_delay).c_str());
+
+   return queue_delay;
+}
@@ -0,0 +1,60 @@
+#ifndef __QUEUE_MODEL_HISTORY_FLAT_H__
+#define __QUEUE_MODEL_HISTORY_FLAT_H__
+
+#include "queue_model.h"
+#include "fixed_types.h"
+#include "moving_average.h"
+
+#include <vector>
+
+// Same model as QueueModelHistoryList, but the free intervals are kept in a flat, sorted array instead of a linked list.
+// Free intervals never overlap, so they are sorted on both their start and their end time, and the interval a request
+// fits into is found using a binary search. The array is allocated once: intervals are inserted and removed by moving
+// the (usually short) part of the array behind them, the oldest intervals are dropped by advancing the start index.
+class QueueModelHistoryFlat : public QueueModel
+{
+public:
+   QueueModelHistoryFlat(String name, UInt32 id, SubsecondTime min_processing_time);
+   ~QueueModelHistoryFlat();
+
+   SubsecondTime computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester = INVALID_CORE_ID);
+
+   float getQueueUtilization();
+   float getFracRequestsUsingAnalyticalModel();
+
+private:
+   struct Interval
+   {
+      SubsecondTime start;
+      SubsecondTime end;
+   };
+
+   SubsecondTime m_min_processing_time;
+   UInt32 m_max_free_interval_list_size;
+
+   // Free intervals are m_intervals[m_first .. m_last)
+   std::vector<Interval> m_intervals;
+   UInt32 m_first;
+   UInt32 m_last;
+
+   // Tracks queue utilization
+   SubsecondTime m_utilized_time;
+   SubsecondTime m_total_queue_delay;
+   MovingAverage<SubsecondTime>* m_average_delay;
+
+   // Is analytical model used ?
+   bool m_analytical_model_enabled;
+
+   // Performance Counters
+   UInt64 m_total_requests;
+   UInt64 m_total_requests_using_analytical_model;
+
+   static bool endsBefore(const Interval &interval, SubsecondTime time) { return interval.end < time; }
+   static bool startsAfter(SubsecondTime time, const Interval &interval) { return time < interval.start; }
+
+   void replaceInterval(UInt32 index, const Interval *intervals, UInt32 count);
+   SubsecondTime computeUsingHistoryList(SubsecondTime pkt_time, SubsecondTime processing_time);
+   SubsecondTime computeUsingAnalyticalModel(SubsecondTime pkt_time, SubsecondTime processing_time);
+};
+
+#endif /* __QUEUE_MODEL_HISTORY_FLAT_H__ */
@@ -3,6 +3,9 @@
 #include "config.hpp"
 #include "log.h"
 #include "stats.h"
+#include "itostr.h"
+
+#include <algorithm>
 
 QueueModelWindowedMG1::QueueModelWindowedMG1(String name, UInt32 id)
    : m_window_size(SubsecondTime::NS(Sim()->getCfg()->getInt("queue_model/windowed_mg1/window_size")))
@@ -12,23 +15,38 @@ QueueModelWindowedMG1::QueueModelWindowedMG1(String name, UInt32 id)
    , m_num_arrivals(0)
    , m_service_time_sum(0)
    , m_service_time_sum2(0)
+   , m_trace(NULL)
 {
    registerStatsMetric(name, id, "num-requests", &m_total_requests);
    registerStatsMetric(name, id, "total-time-used", &m_total_utilized_time);
    registerStatsMetric(name, id, "total-queue-delay", &m_total_queue_delay);
+
+   if (Sim()->getCfg()->getBool("queue_model/windowed_mg1/record_trace"))
+   {
+      String filename = Sim()->getConfig()->formatOutputFileName("sim.queuetrace." + name + "." + itostr(id));
+      m_trace = fopen(filename.c_str(), "w");
+      LOG_ASSERT_ERROR(m_trace, "Cannot open queue trace file %s", filename.c_str());
+   }
 }
 
 QueueModelWindowedMG1::~QueueModelWindowedMG1()
-{}
+{
+   if (m_trace)
+      fclose(m_trace);
+}
 
 SubsecondTime
 QueueModelWindowedMG1::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester)
 {
    SubsecondTime t_queue = SubsecondTime::Zero();
+   SubsecondTime global_time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
+
+   if (m_trace)
+      fprintf(m_trace, "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n", global_time.getPS(), pkt_time.getPS(), processing_time.getPS());
 
    // Advance the window based on the global (barrier) time, as this guarantees the earliest time any thread may be at.
    // Use a backup value of 10 window sizes before the current request to avoid excessive memory usage in case something fishy is going on.
-   removeItems(std::max(Sim()->getClockSkewMinimizationServer()->getGlobalTime() - m_window_size, pkt_time - 10*m_window_size));
+   removeItems(std::max(global_time - m_window_size, pkt_time - 10*m_window_size));
 
    if (m_num_arrivals > 1)
    {
@@ -60,7 +78,10 @@ QueueModelWindowedMG1::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime p
 void
 QueueModelWindowedMG1::addItem(SubsecondTime pkt_time, SubsecondTime service_time)
 {
-   m_window.insert(std::pair<SubsecondTime, SubsecondTime>(pkt_time, service_time));
+   Item item = { pkt_time, service_time };
+   m_window.push_back(item);
+   std::push_heap(m_window.begin(), m_window.end(), Item::arrivesLater);
+
    m_num_arrivals ++;
    m_service_time_sum += service_time.getPS();
    m_service_time_sum2 += service_time.getPS() * service_time.getPS();
@@ -69,12 +90,13 @@ QueueModelWindowedMG1::addItem(SubsecondTime pkt_time, SubsecondTime service_tim
 void
 QueueModelWindowedMG1::removeItems(SubsecondTime earliest_time)
 {
-   while(!m_window.empty() && m_window.begin()->first < earliest_time)
+   while(!m_window.empty() && m_window.front().pkt_time < earliest_time)
    {
-      std::multimap<SubsecondTime, SubsecondTime>::iterator entry = m_window.begin();
+      const Item &entry = m_window.front();
       m_num_arrivals --;
-      m_service_time_sum -= entry->second.getPS();
-      m_service_time_sum2 -= entry->second.getPS() * entry->second.getPS();
-      m_window.erase(entry);
+      m_service_time_sum -= entry.service_time.getPS();
+      m_service_time_sum2 -= entry.service_time.getPS() * entry.service_time.getPS();
+      std::pop_heap(m_window.begin(), m_window.end(), Item::arrivesLater);
+      m_window.pop_back();
    }
 }
@@ -5,7 +5,8 @@
 #include "fixed_types.h"
 #include "contention_model.h"
 
-#include <map>
+#include <vector>
+#include <cstdio>
 
 class QueueModelWindowedMG1 : public QueueModel
 {
@@ -22,11 +23,25 @@ private:
    SubsecondTime m_total_utilized_time;
    SubsecondTime m_total_queue_delay;
 
-   std::multimap<SubsecondTime, SubsecondTime> m_window;
+   // Requests in the current window, in a binary min-heap on arrival time.
+   // Arrival times are mostly increasing, so a new request usually stays at the bottom of the heap,
+   // and requests leave the window from the top. Unlike a sorted buffer, this stays cheap when
+   // requests from many cores arrive interleaved out of order.
+   struct Item
+   {
+      SubsecondTime pkt_time;
+      SubsecondTime service_time;
+      // Heap order: the earliest arrival is at the top
+      static bool arrivesLater(const Item &a, const Item &b) { return a.pkt_time > b.pkt_time; }
+   };
+   std::vector<Item> m_window;
    UInt64 m_num_arrivals;
    UInt64 m_service_time_sum; // In ps
    UInt64 m_service_time_sum2; // In ps^2
 
+   // Request stream, written when queue_model/windowed_mg1/record_trace is set so it can be replayed outside of the simulator
+   FILE *m_trace;
+
    void addItem(SubsecondTime pkt_time, SubsecondTime service_time);
    void removeItems(SubsecondTime earliest_time);
 };
@@ -14,16 +14,25 @@
 #include "circular_log.h"
 
 #include <algorithm>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 BarrierSyncServer::BarrierSyncServer()
    : m_local_clock_list(Sim()->getConfig()->getApplicationCores(), SubsecondTime::Zero())
    , m_barrier_acquire_list(Sim()->getConfig()->getApplicationCores(), false)
-   , m_core_cond(Sim()->getConfig()->getApplicationCores(), NULL)
+   , m_core_futex(new UInt32[Sim()->getConfig()->getApplicationCores()])
+   , m_num_arrived(0)
+   , m_num_expected(0)
    , m_core_group(Sim()->getConfig()->getApplicationCores(), INVALID_CORE_ID)
    , m_core_thread(Sim()->getConfig()->getApplicationCores(), INVALID_THREAD_ID)
    , m_global_time(SubsecondTime::Zero())
    , m_fastforward(false)
    , m_disable(false)
+   , m_adaptive(false)
+   , m_interaction(false)
+   , m_quantum_increases(0)
+   , m_quantum_decreases(0)
 {
    try
    {
@@ -34,8 +43,20 @@ BarrierSyncServer::BarrierSyncServer()
       LOG_PRINT_ERROR("Error Reading 'clock_skew_minimization/barrier/quantum' from the config file");
    }
 
+   m_adaptive = Sim()->getCfg()->getBool("clock_skew_minimization/barrier/adaptive");
+   m_quantum_min = m_quantum_max = m_barrier_interval;
+   if (m_adaptive)
+   {
+      m_quantum_min = SubsecondTime::NS() * (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/barrier/quantum_min");
+      m_quantum_max = SubsecondTime::NS() * (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/barrier/quantum_max");
+      LOG_ASSERT_ERROR(m_quantum_min > SubsecondTime::Zero() && m_quantum_min <= m_quantum_max,
+                       "Invalid clock_skew_minimization/barrier/quantum_min (%s) or quantum_max (%s)", itostr(m_quantum_min).c_str(), itostr(m_quantum_max).c_str());
+      // Start from the static quantum
+      m_barrier_interval = std::min(m_quantum_max, std::max(m_quantum_min, m_barrier_interval));
+   }
+
    for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
-      m_core_cond[core_id] = new ConditionVariable();
+      m_core_futex[core_id] = 0;
 
    m_next_barrier_time = m_barrier_interval;
 
@@ -43,22 +64,32 @@ BarrierSyncServer::BarrierSyncServer()
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_EXIT, BarrierSyncServer::hookThreadExit, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_STALL, BarrierSyncServer::hookThreadStall, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_MIGRATE, BarrierSyncServer::hookThreadMigrate, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
+   if (m_adaptive)
+      Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_RESUME, BarrierSyncServer::hookThreadResume, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
 
    registerStatsMetric("barrier", 0, "global_time", &m_global_time);
+   registerStatsMetric("barrier", 0, "quantum", &m_barrier_interval);
+   registerStatsMetric("barrier", 0, "quantum_increases", &m_quantum_increases);
+   registerStatsMetric("barrier", 0, "quantum_decreases", &m_quantum_decreases);
 }
 
 BarrierSyncServer::~BarrierSyncServer()
 {
-   for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
-      delete m_core_cond[core_id];
+   delete [] m_core_futex;
 }
 
 void
 BarrierSyncServer::synchronize(core_id_t core_id, SubsecondTime time)
 {
-   ScopedLock sl(Sim()->getThreadManager()->getLock());
+   // Most calls are made before the next barrier time and return without taking any lock.
+   // m_next_barrier_time only increases, a stale value just sends us down the locked path where it is checked again.
    if (m_disable)
       return;
+   if (time < m_next_barrier_time && !m_fastforward)
+   {
+      CLOG("barrier", "Core %d immediate exit", core_id);
+      return;
+   }
 
    Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
    core_id_t master_core_id;
@@ -69,41 +100,74 @@ BarrierSyncServer::synchronize(core_id_t core_id, SubsecondTime time)
    Core *master_core = Sim()->getCoreManager()->getCoreFromID(core_id);
    thread_id_t thread_me = core->getThread()->getId();
 
-   CLOG("barrier", "Core %d entry (master core %d, thread %d, ffwd %d)", core_id, master_core_id, thread_me, m_fastforward);
-   LOG_PRINT("Received 'SIM_BARRIER_WAIT' from Core(%i), Time(%s)", core_id, itostr(time).c_str());
+   UInt32 futex;
+   bool maybe_last;
+   {
+      ScopedLock sl(m_lock);
+      if (m_disable)
+         return;
 
-   LOG_ASSERT_ERROR(core->getState() == Core::RUNNING || core->getState() == Core::INITIALIZING, "Core(%i) is not running or initializing at time(%s)", core_id, itostr(time).c_str());
-   LOG_ASSERT_ERROR(m_barrier_acquire_list[master_core_id] == false, "Core(%i) or its sibling is already in the barrier (this is thread %d, we have thread %d)", master_core_id, thread_me, m_core_thread[master_core_id]);
+      CLOG("barrier", "Core %d entry (master core %d, thread %d, ffwd %d)", core_id, master_core_id, thread_me, m_fastforward);
+      LOG_PRINT("Received 'SIM_BARRIER_WAIT' from Core(%i), Time(%s)", core_id, itostr(time).c_str());
 
-   if (time < m_next_barrier_time && !m_fastforward)
-   {
-      LOG_PRINT("Sent 'SIM_BARRIER_RELEASE' immediately time(%s), m_next_barrier_time(%s)", itostr(time).c_str(), itostr(m_next_barrier_time).c_str());
-      // LOG_PRINT_WARNING("core_id(%i), local_clock(%llu), m_next_barrier_time(%llu), m_barrier_interval(%llu)", core_id, time, m_next_barrier_time, m_barrier_interval);
-      CLOG("barrier", "Core %d immediate exit", core_id);
-      return;
-   }
+      LOG_ASSERT_ERROR(core->getState() == Core::RUNNING || core->getState() == Core::INITIALIZING, "Core(%i) is not running or initializing at time(%s)", core_id, itostr(time).c_str());
+      LOG_ASSERT_ERROR(m_barrier_acquire_list[master_core_id] == false, "Core(%i) or its sibling is already in the barrier (this is thread %d, we have thread %d)", master_core_id, thread_me, m_core_thread[master_core_id]);
 
-   // One thread entered the barrier, another one can resume
-   doRelease(1);
+      if (time < m_next_barrier_time && !m_fastforward)
+      {
+         LOG_PRINT("Sent 'SIM_BARRIER_RELEASE' immediately time(%s), m_next_barrier_time(%s)", itostr(time).c_str(), itostr(m_next_barrier_time).c_str());
+         // LOG_PRINT_WARNING("core_id(%i), local_clock(%llu), m_next_barrier_time(%llu), m_barrier_interval(%llu)", core_id, time, m_next_barrier_time, m_barrier_interval);
+         CLOG("barrier", "Core %d immediate exit", core_id);
+         return;
+      }
+
+      // One thread entered the barrier, another one can resume
+      doRelease(1);
 
-   master_core->getPerformanceModel()->barrierEnter();
+      master_core->getPerformanceModel()->barrierEnter();
 
-   m_local_clock_list[master_core_id] = time;
-   m_barrier_acquire_list[master_core_id] = true;
-   m_core_thread[master_core_id] = thread_me;
+      m_local_clock_list[master_core_id] = time;
+      m_barrier_acquire_list[master_core_id] = true;
+      m_core_thread[master_core_id] = thread_me;
+
+      futex = m_core_futex[master_core_id];
+      ++m_num_arrived;
+      maybe_last = m_num_arrived >= m_num_expected;
+   }
 
+   // Only when everyone that was running at the last barrier has arrived, do the full check (which needs the thread manager's state).
+   // Threads that stopped running since then call signal() from their stall or exit hook, which does the same check.
    bool mustWait = true;
-   if (isBarrierReached())
-      mustWait = barrierRelease(thread_me);
+   if (maybe_last)
+   {
+      ScopedLock sl(Sim()->getThreadManager()->getLock());
+      if (!m_disable && isBarrierReached())
+         mustWait = barrierRelease(thread_me);
+   }
 
    if (mustWait)
-      m_core_cond[master_core_id]->wait(Sim()->getThreadManager()->getLock());
+      waitForRelease(master_core_id, futex);
    else
       master_core->getPerformanceModel()->barrierExit();
 
    CLOG("barrier", "Core %d exit (master core %d, thread %d)", core_id, master_core_id, thread_me);
 }
 
+void
+BarrierSyncServer::waitForRelease(core_id_t core_id, UInt32 futex)
+{
+   // Returns immediately if we were released in the mean time (m_core_futex no longer equals futex)
+   while (m_core_futex[core_id] == futex)
+      syscall(SYS_futex, (void*) &m_core_futex[core_id], FUTEX_WAIT | FUTEX_PRIVATE_FLAG, futex, NULL, NULL, 0);
+}
+
+void
+BarrierSyncServer::wakeCore(core_id_t core_id)
+{
+   __sync_fetch_and_add(&m_core_futex[core_id], 1);
+   syscall(SYS_futex, (void*) &m_core_futex[core_id], FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+}
+
 void
 BarrierSyncServer::threadExit(HooksManager::ThreadTime *argument)
 {
@@ -134,6 +198,7 @@ BarrierSyncServer::threadMigrate(HooksManager::ThreadMigrate *argument)
 void
 BarrierSyncServer::releaseThread(thread_id_t thread_id)
 {
+   ScopedLock sl(m_lock);
    for(core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
    {
       if (m_barrier_acquire_list[core_id] && m_core_thread[core_id] == thread_id)
@@ -152,10 +217,28 @@ BarrierSyncServer::signal()
    if (m_disable)
       return;
 
+   // A thread stopped running, fewer cores need to arrive at the barrier
+   updateExpected();
+
    if (isBarrierReached())
       barrierRelease(INVALID_THREAD_ID);
 }
 
+void
+BarrierSyncServer::updateExpected()
+{
+   // Called with the thread manager lock held
+   ScopedLock sl(m_lock);
+
+   m_num_expected = 0;
+   for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   {
+      // The same cores isBarrierReached() waits for
+      if ((m_fastforward || m_core_group[core_id] == INVALID_CORE_ID) && isCoreRunning(core_id))
+         ++m_num_expected;
+   }
+}
+
 bool
 BarrierSyncServer::isCoreRunning(core_id_t core_id, bool siblings)
 {
@@ -192,6 +275,7 @@ BarrierSyncServer::advance()
 bool
 BarrierSyncServer::isBarrierReached()
 {
+   ScopedLock sl(m_lock);
    bool single_core_barrier_reached = false;
 
    // Check if all cores have reached the barrier
@@ -246,15 +330,19 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
    // Advance m_next_barrier_time
    // Release the Barrier
 
-   LOG_ASSERT_ERROR(m_to_release.size() == 0, "Reached the barrier while some threads haven't even restarted?");
-
-   if (m_fastforward)
    {
-      for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+      ScopedLock sl(m_lock);
+
+      LOG_ASSERT_ERROR(m_to_release.size() == 0, "Reached the barrier while some threads haven't even restarted?");
+
+      if (m_fastforward)
       {
-         // In fast-forward mode, skip over (potentially very many) timeslots
-         if (m_local_clock_list[core_id] > m_next_barrier_time)
-            m_next_barrier_time = m_local_clock_list[core_id];
+         for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+         {
+            // In fast-forward mode, skip over (potentially very many) timeslots
+            if (m_local_clock_list[core_id] > m_next_barrier_time)
+               m_next_barrier_time = m_local_clock_list[core_id];
+         }
       }
    }
 
@@ -264,6 +352,7 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
 
    bool core_resumed = false;
    bool must_wait = true;
+   bool adapted = false;
    while (!core_resumed)
    {
       m_global_time = m_next_barrier_time;
@@ -283,7 +372,17 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
       if (m_disable)
          return false;
 
-      m_next_barrier_time += m_barrier_interval;
+      // Not held while calling HOOK_PERIODIC, as its handlers may call back into releaseThread()
+      ScopedLock sl(m_lock);
+
+      if (m_adaptive && !m_fastforward && !adapted)
+      {
+         // Only once per release, the following iterations skip over time in which no core was running
+         adaptQuantum();
+         adapted = true;
+      }
+      else
+         m_next_barrier_time += m_barrier_interval;
       LOG_PRINT("m_next_barrier_time updated to (%s)", itostr(m_next_barrier_time).c_str());
 
       for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
@@ -297,6 +396,7 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
                //LOG_ASSERT_ERROR(core->getState() == Core::RUNNING || core->getState() == Core::INITIALIZING, "(%i) has acquired barrier, local_clock(%s), m_next_barrier_time(%s), but not initializing or running", core_id, itostr(m_local_clock_list[core_id]).c_str(), itostr(m_next_barrier_time).c_str());
 
                m_barrier_acquire_list[core_id] = false;
+               --m_num_arrived;
                core_resumed = true;
 
                if (m_core_thread[core_id] == caller_id)
@@ -315,22 +415,52 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
    // To avoid overwhelming the OS scheduler, we only release N threads at a time (N ~= host cores).
    // Once a thread is done (stops executing because it completed the next barrier quantum, or due to thread stall),
    // one more thread is released so we always have at most N running threads.
-   std::random_shuffle(m_to_release.begin(), m_to_release.end());
-   doRelease(m_fastforward ? -1 : Sim()->getConfig()->getNumHostCores());
+   {
+      ScopedLock sl(m_lock);
+      std::random_shuffle(m_to_release.begin(), m_to_release.end());
+      doRelease(m_fastforward ? -1 : Sim()->getConfig()->getNumHostCores());
+   }
+
+   // Cores that are running now should all arrive before the next barrier can be reached
+   updateExpected();
 
    return must_wait;
 }
 
+void
+BarrierSyncServer::adaptQuantum()
+{
+   // Called with m_lock held
+   if (__sync_bool_compare_and_swap(&m_interaction, true, false))
+   {
+      if (m_barrier_interval > m_quantum_min)
+      {
+         m_barrier_interval = std::max(m_quantum_min, m_barrier_interval / 2);
+         ++m_quantum_decreases;
+      }
+   }
+   else if (m_barrier_interval < m_quantum_max)
+   {
+      m_barrier_interval = std::min(m_quantum_max, m_barrier_interval * 2);
+      ++m_quantum_increases;
+   }
+
+   // Keep barriers at multiples of the quantum, which is where BarrierSyncClient expects them
+   m_next_barrier_time = ((m_next_barrier_time / m_barrier_interval) * m_barrier_interval) + m_barrier_interval;
+   CLOG("barrier", "Quantum %" PRId64 "ns", m_barrier_interval.getNS());
+}
+
 void
 BarrierSyncServer::doRelease(int n)
 {
    // Release up to n threads from the list.
    // When n == -1, all threads are released
+   // Called with m_lock held
    while(m_to_release.size() && n--)
    {
       core_id_t core_id = m_to_release.back();
       m_to_release.pop_back();
-      m_core_cond[core_id]->signal();
+      wakeCore(core_id);
    }
 }
 
@@ -338,16 +468,18 @@ void
 BarrierSyncServer::abortBarrier()
 {
    CLOG("barrier", "Abort");
+   ScopedLock sl(m_lock);
    for(core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
    {
       // Check if this core was running. If yes, release that core
       if (m_barrier_acquire_list[core_id] == true)
       {
          m_barrier_acquire_list[core_id] = false;
+         --m_num_arrived;
 
          Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
          core->getPerformanceModel()->barrierExit();
-         m_core_cond[core_id]->signal();
+         wakeCore(core_id);
       }
    }
 }
@@ -363,18 +495,24 @@ BarrierSyncServer::setDisable(bool disable)
 void
 BarrierSyncServer::setGroup(core_id_t core_id, core_id_t master_core_id)
 {
+   ScopedLock sl(m_lock);
    if (master_core_id != INVALID_CORE_ID)
       LOG_ASSERT_ERROR(m_barrier_acquire_list[core_id] == false, "Core(%d) is in the barrier, cannot set participate to false", core_id);
 
    m_core_group[core_id] = master_core_id;
+   // Until the next barrier, let every arriving core check whether it is the last one
+   m_num_expected = 0;
 }
 
 void
 BarrierSyncServer::setFastForward(bool fastforward, SubsecondTime next_barrier_time)
 {
+   ScopedLock sl(m_lock);
    if (m_fastforward != fastforward)
       CLOG("barrier", "FastForward %d > %d", m_fastforward, fastforward);
    m_fastforward = fastforward;
+   // The set of cores we wait for changes, until the next barrier let every arriving core check whether it is the last one
+   m_num_expected = 0;
    if (next_barrier_time != SubsecondTime::MaxTime())
    {
       m_next_barrier_time = std::max(m_next_barrier_time, next_barrier_time);
@@ -384,6 +522,7 @@ BarrierSyncServer::setFastForward(bool fastforward, SubsecondTime next_barrier_t
 void
 BarrierSyncServer::printState(void)
 {
+   ScopedLock sl(m_lock);
    printf("Barrier state:");
    for(core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
    {
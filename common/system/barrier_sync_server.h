@@ -2,7 +2,7 @@
 #define __BARRIER_SYNC_SERVER_H__
 
 #include "fixed_types.h"
-#include "cond.h"
+#include "lock.h"
 #include "hooks_manager.h"
 
 #include <vector>
@@ -14,9 +14,16 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
    private:
       SubsecondTime m_barrier_interval;
       SubsecondTime m_next_barrier_time;
+      // Cores enter the barrier holding only m_lock, which protects the per-core state below.
+      // Checking whether the barrier was reached, and releasing it, also needs the thread manager's lock
+      // (and is done by the core that may be the last to arrive, or when a thread stops running).
+      // Lock order: thread manager lock, then m_lock.
+      Lock m_lock;
       std::vector<SubsecondTime> m_local_clock_list;
       std::vector<bool> m_barrier_acquire_list;
-      std::vector<ConditionVariable*> m_core_cond;
+      volatile UInt32 *m_core_futex; // Incremented when a core is released from the barrier
+      UInt32 m_num_arrived;          // Cores in the barrier
+      UInt32 m_num_expected;         // Cores that were running at the last barrier, the barrier cannot be reached with fewer arrivals
       std::vector<core_id_t> m_to_release;
       std::vector<core_id_t> m_core_group;
       std::vector<thread_id_t> m_core_thread;
@@ -24,6 +31,15 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       bool m_fastforward;
       volatile bool m_disable;
 
+      // Adaptive quantum (clock_skew_minimization/barrier/adaptive): at each barrier, widen the quantum if the cores
+      // did not interact during the last interval, shrink it if they did, within [m_quantum_min, m_quantum_max]
+      bool m_adaptive;
+      SubsecondTime m_quantum_min;
+      SubsecondTime m_quantum_max;
+      volatile bool m_interaction;
+      UInt64 m_quantum_increases;
+      UInt64 m_quantum_decreases;
+
       bool isBarrierReached(void);
       bool barrierRelease(thread_id_t thread_id = INVALID_THREAD_ID, bool continue_until_release = false);
       void abortBarrier(void);
@@ -31,6 +47,10 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       void releaseThread(thread_id_t thread_id);
       void signal();
       void doRelease(int n);
+      void wakeCore(core_id_t core_id);
+      void waitForRelease(core_id_t core_id, UInt32 futex);
+      void updateExpected(void);
+      void adaptQuantum(void);
 
       static SInt64 hookThreadExit(UInt64 object, UInt64 argument) {
          ((BarrierSyncServer*)object)->threadExit((HooksManager::ThreadTime*)argument); return 0;
@@ -41,6 +61,9 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       static SInt64 hookThreadMigrate(UInt64 object, UInt64 argument) {
          ((BarrierSyncServer*)object)->threadMigrate((HooksManager::ThreadMigrate*)argument); return 0;
       }
+      static SInt64 hookThreadResume(UInt64 object, UInt64 argument) {
+         ((BarrierSyncServer*)object)->notifyInteraction(); return 0;
+      }
       void threadExit(HooksManager::ThreadTime *argument);
       void threadStall(HooksManager::ThreadStall *argument);
       void threadMigrate(HooksManager::ThreadMigrate *argument);
@@ -58,6 +81,8 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       SubsecondTime getGlobalTime(bool upper_bound = false) { return upper_bound ? m_next_barrier_time : m_global_time; }
       void setBarrierInterval(SubsecondTime barrier_interval) { m_barrier_interval = barrier_interval; }
       SubsecondTime getBarrierInterval() const { return m_barrier_interval; }
+      // Only write the flag once per interval, this is called often and from all cores
+      void notifyInteraction() { if (!m_interaction) m_interaction = true; }
 
       void printState(void);
 };
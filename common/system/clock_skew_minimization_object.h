@@ -64,6 +64,8 @@ public:
    virtual SubsecondTime getGlobalTime(bool upper_bound = false);
    virtual void setBarrierInterval(SubsecondTime barrier_interval) = 0;
    virtual SubsecondTime getBarrierInterval() const = 0;
+   // Cores interacted (coherence traffic, synchronization, thread wake-up), can be called from any thread
+   virtual void notifyInteraction() {}
 
    virtual void printState(void) {}
 };
@@ -112,6 +112,17 @@ core_id_t CoreManager::registerSimThread(ThreadType type)
     return core->getId();
 }
 
+void CoreManager::registerSimWorkerThread()
+{
+    m_core_tls->set(NULL);
+    m_thread_type_tls->setInt(SIM_THREAD);
+}
+
+void CoreManager::setSimWorkerCore(core_id_t core_id)
+{
+    m_core_tls->set(core_id == INVALID_CORE_ID ? NULL : m_cores.at(core_id));
+}
+
 bool CoreManager::amiSimThread()
 {
     return m_thread_type_tls->getInt() == SIM_THREAD;
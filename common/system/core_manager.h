@@ -31,6 +31,9 @@ class CoreManager
       void initializeThread(core_id_t core_id);
       void terminateThread();
       core_id_t registerSimThread(ThreadType type);
+      // Sim thread pool workers are not tied to a core, they switch to each core they do work for
+      void registerSimWorkerThread();
+      void setSimWorkerCore(core_id_t core_id);
 
       core_id_t getCurrentCoreID(int threadIndex = -1) // id of currently active core (or INVALID_CORE_ID)
       {
@@ -7,8 +7,6 @@
 #include "sim_thread_manager.h"
 #include "sim_api.h"
 
-#include <unistd.h>
-
 CoreThread::CoreThread()
    : m_thread(NULL)
 {
@@ -30,20 +28,17 @@ void CoreThread::run()
    LOG_PRINT("Core thread starting...");
 
    Network *net = Sim()->getCoreManager()->getCoreFromID(core_id)->getNetwork();
-   volatile bool cont = true;
+   PerformanceModel *prfmdl = Sim()->getCoreManager()->getCurrentCore()->getPerformanceModel();
 
    Sim()->getSimThreadManager()->simThreadStartCallback();
 
-   // Turn off cont when we receive a quit message
+   // Stop the performance model when we receive a quit message
    net->registerCallback(CORE_THREAD_TERMINATE_THREADS,
                          terminateFunc,
-                         (void *)&cont);
+                         (void *)prfmdl);
 
-   PerformanceModel *prfmdl = Sim()->getCoreManager()->getCurrentCore()->getPerformanceModel();
-   while (cont) {
-      prfmdl->iterate();
-      usleep(1000); // Reduce system load while there's nothing to do (outside ROI)
-   }
+   // Simulate instructions as the front end queues them, sleeps while there's nothing to do (outside ROI)
+   prfmdl->run();
 
    Sim()->getSimThreadManager()->simThreadExitCallback();
 
@@ -58,6 +53,6 @@ void CoreThread::spawn()
 
 void CoreThread::terminateFunc(void *vp, NetPacket pkt)
 {
-   bool *pcont = (bool*) vp;
-   *pcont = false;
+   PerformanceModel *prfmdl = (PerformanceModel*) vp;
+   prfmdl->stop();
 }
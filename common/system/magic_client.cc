@@ -6,6 +6,7 @@
 #include "core_manager.h"
 #include "thread.h"
 #include "thread_manager.h"
+#include "approx_table.h"
 
 static UInt64 handleMagic(thread_id_t thread_id, UInt64 cmd, UInt64 arg0 = 0, UInt64 arg1 = 0)
 {
@@ -21,7 +22,6 @@ void setInstrumentationMode(UInt64 opt)
 
 UInt64 handleMagicInstruction(thread_id_t thread_id, UInt64 cmd, UInt64 arg0, UInt64 arg1)
 {
-   int table_return = -1;
    switch(cmd)
    {
    case SIM_CMD_ROI_TOGGLE:
@@ -33,39 +33,34 @@ UInt64 handleMagicInstruction(thread_id_t thread_id, UInt64 cmd, UInt64 arg0, UI
    case SIM_CMD_USER:
    //AMHM Start
    case AMHM_APPROX:
-       table_return = Sim()->approx_table_search((unsigned long long int) arg0);
-       if(table_return != -1) {
-           printf("AMHM: A quality level is already assigned to a data starts from address 0x%llx.\n\
+   {
+       ApproxTable::Entry *entry = Sim()->getApproxTable()->add(arg0, arg1);
+       if(entry == NULL) {
+           printf("AMHM: A quality level is already assigned to a data overlapping address range 0x%llx-0x%llx.\n\
                    If you want to assign another quality level to this data, please first remove it\n\
                    with AMHM_accurate command and then add it again to approximation table with a\n\
-                   AMHM_approx following with AMHM_qual commands.\n", (unsigned long long int) arg0);
-       }
-       else {
-            Sim()->approx_table_entry = (Sim()->approx_table_entry + 1) % approx_table_max_entry;
-            Sim()->approx_table[Sim()->approx_table_entry].start_address = arg0;
-            Sim()->approx_table[Sim()->approx_table_entry].end_address = arg1;
-            Sim()->approx_table[Sim()->approx_table_entry].quality_level = 0;
-            //Aligning addresses considering 64 byte cache block size for fault injection
-            Sim()->approx_table[Sim()->approx_table_entry].start_address = Sim()->approx_table[Sim()->approx_table_entry].start_address + 0xD0;
-            Sim()->approx_table[Sim()->approx_table_entry].start_address = Sim()->approx_table[Sim()->approx_table_entry].start_address & 0xFFFFFFFFFFC0;
-            Sim()->approx_table[Sim()->approx_table_entry].end_address = Sim()->approx_table[Sim()->approx_table_entry].end_address & 0xFFFFFFFFFFC0;
+                   AMHM_approx following with AMHM_qual commands.\n", (unsigned long long int) arg0, (unsigned long long int) arg1);
        }
        return 0;
+   }
    case AMHM_QUAL:
-       Sim()->approx_table[Sim()->approx_table_entry].quality_level = *(double*) &arg0;
-       printf("AMHM: Start Address Fed to Sniper: 0x%llx, End Address Fed to Sniper: 0x%llx, and Quality Level Fed to Sniper: %e\n",\
-              Sim()->approx_table[Sim()->approx_table_entry].start_address, Sim()->approx_table[Sim()->approx_table_entry].end_address,\
-              Sim()->approx_table[Sim()->approx_table_entry].quality_level);
+   {
+       ApproxTable::Entry *entry = Sim()->getApproxTable()->setQuality(*(double*) &arg0);
+       if(entry != NULL) {
+           printf("AMHM: Start Address Fed to Sniper: 0x%llx, End Address Fed to Sniper: 0x%llx, and Quality Level Fed to Sniper: %e\n",\
+                  (unsigned long long int) entry->start_address, (unsigned long long int) entry->end_address, entry->quality_level);
+       }
        return 0;
+   }
    case AMHM_ACCURATE:
-       table_return = Sim()->approx_table_del((unsigned long long int) arg0);
-       if(table_return != -1) {
-            Sim()->approx_table[table_return].quality_level = 0;
+   {
+       ApproxTable::Entry *entry = Sim()->getApproxTable()->remove(arg0);
+       if(entry != NULL)
             printf("AMHM: Address 0x%llx is set to accurate mode\n", (unsigned long long int) arg0);
-       }
        else
             printf("AMHM: Address 0x%llx is not found in approximation table\n", (unsigned long long int) arg0);
-       return 0;     
+       return 0;
+   }
    //AMHM End
    case SIM_CMD_INSTRUMENT_MODE:
    case SIM_CMD_MHZ_GET:
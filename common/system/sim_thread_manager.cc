@@ -4,9 +4,15 @@
 #include "log.h"
 #include "config.h"
 #include "simulator.h"
+#include "config.hpp"
+
+#include <algorithm>
 
 SimThreadManager::SimThreadManager()
-   : m_active_threads(0)
+   : m_sim_threads(NULL)
+   , m_sim_thread_pool(NULL)
+   , m_core_threads(NULL)
+   , m_active_threads(0)
 {
 }
 
@@ -19,23 +25,39 @@ SimThreadManager::~SimThreadManager()
 void SimThreadManager::spawnSimThreads()
 {
    UInt32 num_cores = Config::getSingleton()->getTotalCores();
+   UInt32 num_network_threads = num_cores;
+   if (Sim()->getCfg()->getBool("general/sim_thread_pool"))
+   {
+      num_network_threads = Sim()->getCfg()->getInt("general/sim_thread_pool_size");
+      if (num_network_threads == 0)
+         num_network_threads = Config::getSingleton()->getNumHostCores();
+      // There is no use in having more workers than cores (also covers num_host_cores = -1)
+      num_network_threads = std::min(num_network_threads, num_cores);
+   }
    #ifdef ENABLE_PERF_MODEL_OWN_THREAD
-   __attribute__((unused)) UInt32 num_sim_threads = 2 * num_cores;
+   __attribute__((unused)) UInt32 num_sim_threads = num_network_threads + num_cores;
    #else
-   __attribute__((unused)) UInt32 num_sim_threads = num_cores;
+   __attribute__((unused)) UInt32 num_sim_threads = num_network_threads;
    #endif
 
    LOG_PRINT("Starting %d threads.", num_sim_threads);
 
-   m_sim_threads = new SimThread [num_cores];
+   if (Sim()->getCfg()->getBool("general/sim_thread_pool"))
+      m_sim_thread_pool = new SimThreadPool(num_network_threads);
+   else
+      m_sim_threads = new SimThread [num_cores];
    #ifdef ENABLE_PERF_MODEL_OWN_THREAD
    m_core_threads = new CoreThread [num_cores];
    #endif
 
+   if (m_sim_thread_pool)
+      m_sim_thread_pool->spawn();
+
    for (UInt32 i = 0; i < num_cores; i++)
    {
       LOG_PRINT("Starting thread %i", i);
-      m_sim_threads[i].spawn();
+      if (m_sim_threads)
+         m_sim_threads[i].spawn();
       #ifdef ENABLE_PERF_MODEL_OWN_THREAD
       m_core_threads[i].spawn();
       #endif
@@ -80,6 +102,7 @@ void SimThreadManager::quitSimThreads()
    Transport::getSingleton()->barrier();
 
    delete [] m_sim_threads;
+   delete m_sim_thread_pool;
    #ifdef ENABLE_PERF_MODEL_OWN_THREAD
    delete [] m_core_threads;
    #endif
@@ -2,6 +2,7 @@
 #define SIM_THREAD_MANAGER_H
 
 #include "sim_thread.h"
+#include "sim_thread_pool.h"
 #include "core_thread.h"
 
 class SimThreadManager
@@ -18,6 +19,7 @@ public:
    
 private:
    SimThread *m_sim_threads;
+   SimThreadPool *m_sim_thread_pool;
    CoreThread *m_core_threads;
 
    Lock m_active_threads_lock;
@@ -0,0 +1,223 @@
+#include "sim_thread_pool.h"
+#include "sim_thread_manager.h"
+#include "core_manager.h"
+#include "simulator.h"
+#include "core.h"
+#include "tls.h"
+#include "config.h"
+#include "log.h"
+#include "sim_api.h"
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+SimThreadPool::SimThreadPool(UInt32 num_workers)
+   : m_num_workers(num_workers)
+   , m_num_cores(Config::getSingleton()->getTotalCores())
+   , m_cores(m_num_cores)
+   , m_worker_tls(TLS::create())
+   , m_num_queued(0)
+   , m_num_running_cores(m_num_cores)
+   , m_done(false)
+   , m_num_sleeping(0)
+   , m_wake_futex(0)
+{
+   LOG_ASSERT_ERROR(m_num_workers > 0, "Need at least one sim thread");
+
+   for (UInt32 i = 0; i < m_num_workers; i++)
+   {
+      m_run_queues.push_back(new RunQueue());
+      m_workers.push_back(new Worker(this, i));
+   }
+}
+
+SimThreadPool::~SimThreadPool()
+{
+   for (UInt32 i = 0; i < m_num_workers; i++)
+   {
+      delete m_workers[i];
+      delete m_run_queues[i];
+   }
+   delete m_worker_tls;
+}
+
+void SimThreadPool::spawn()
+{
+   for (core_id_t core_id = 0; core_id < (core_id_t)m_num_cores; core_id++)
+   {
+      CoreState &core = m_cores[core_id];
+      core.pool = this;
+      core.core_id = core_id;
+      core.network = Sim()->getCoreManager()->getCoreFromID(core_id)->getNetwork();
+      core.transport = core.network->getTransport();
+      core.scheduled = 0;
+
+      core.network->registerCallback(SIM_THREAD_TERMINATE_THREADS, terminateFunc, &core);
+      core.transport->setNotify(notifyFunc, &core);
+      // Pick up anything that was sent before we were listening
+      if (core.transport->query())
+         schedule(core_id);
+   }
+
+   for (UInt32 i = 0; i < m_num_workers; i++)
+   {
+      LOG_PRINT("Starting sim thread pool worker %i", i);
+      m_workers[i]->spawn();
+   }
+}
+
+void SimThreadPool::notifyFunc(void *arg)
+{
+   CoreState *core = (CoreState*)arg;
+   core->pool->schedule(core->core_id);
+}
+
+void SimThreadPool::terminateFunc(void *arg, NetPacket pkt)
+{
+   CoreState *core = (CoreState*)arg;
+   SimThreadPool *pool = core->pool;
+   if (__sync_sub_and_fetch(&pool->m_num_running_cores, 1) == 0)
+   {
+      // All cores were told to quit, workers exit once they run out of work
+      pool->m_done = true;
+      pool->wake(pool->m_num_workers);
+   }
+}
+
+void SimThreadPool::schedule(core_id_t core_id)
+{
+   CoreState &core = m_cores[core_id];
+   // Already on a run queue, or being serviced (the worker will look for new messages when it is done)
+   if (core.scheduled || !__sync_bool_compare_and_swap(&core.scheduled, 0, 1))
+      return;
+
+   UInt32 worker = m_worker_tls->getInt();
+   worker = worker ? worker - 1 : core_id % m_num_workers;
+   {
+      ScopedLock sl(m_run_queues[worker]->lock);
+      m_run_queues[worker]->cores.push_back(core_id);
+   }
+
+   // Full barrier: makes our work visible before checking for sleeping workers, sleep() does the opposite
+   __sync_fetch_and_add(&m_num_queued, 1);
+   if (m_num_sleeping)
+      wake(1);
+}
+
+core_id_t SimThreadPool::take(UInt32 worker)
+{
+   if (m_num_queued <= 0)
+      return INVALID_CORE_ID;
+
+   // Oldest work on our own queue first, then steal the newest work from the others
+   for (UInt32 i = 0; i < m_num_workers; i++)
+   {
+      RunQueue *queue = m_run_queues[(worker + i) % m_num_workers];
+      ScopedLock sl(queue->lock);
+      if (!queue->cores.empty())
+      {
+         core_id_t core_id;
+         if (i == 0)
+         {
+            core_id = queue->cores.front();
+            queue->cores.pop_front();
+         }
+         else
+         {
+            core_id = queue->cores.back();
+            queue->cores.pop_back();
+         }
+         __sync_fetch_and_sub(&m_num_queued, 1);
+         return core_id;
+      }
+   }
+   return INVALID_CORE_ID;
+}
+
+void SimThreadPool::service(core_id_t core_id)
+{
+   CoreState &core = m_cores[core_id];
+
+   Sim()->getCoreManager()->setSimWorkerCore(core_id);
+   if (core.transport->query())
+      core.network->netPullFromTransport();
+   Sim()->getCoreManager()->setSimWorkerCore(INVALID_CORE_ID);
+
+   // Senders that saw us scheduled did not queue the core again: look once more for their messages after unscheduling.
+   // Senders check the flag only after queueing their message, the barrier orders our side.
+   __atomic_store_n(&core.scheduled, 0, __ATOMIC_RELEASE);
+   __sync_synchronize();
+   if (core.transport->query())
+      schedule(core_id);
+}
+
+void SimThreadPool::work(UInt32 worker)
+{
+   while (true)
+   {
+      core_id_t core_id = take(worker);
+      if (core_id != INVALID_CORE_ID)
+         service(core_id);
+      else if (m_done)
+         break;
+      else
+         sleep();
+   }
+}
+
+void SimThreadPool::sleep()
+{
+   UInt32 value = m_wake_futex;
+   // Full barrier: makes our sleeping visible before checking for work, schedule() does the opposite
+   __sync_fetch_and_add(&m_num_sleeping, 1);
+   if (m_num_queued <= 0 && !m_done)
+      syscall(SYS_futex, (void*) &m_wake_futex, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, value, NULL, NULL, 0);
+   __sync_fetch_and_sub(&m_num_sleeping, 1);
+}
+
+void SimThreadPool::wake(UInt32 count)
+{
+   __sync_fetch_and_add(&m_wake_futex, 1);
+   syscall(SYS_futex, (void*) &m_wake_futex, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, count, NULL, NULL, 0);
+}
+
+// -- Worker -- //
+
+SimThreadPool::Worker::Worker(SimThreadPool *pool, UInt32 id)
+   : m_pool(pool)
+   , m_id(id)
+   , m_thread(NULL)
+{
+}
+
+SimThreadPool::Worker::~Worker()
+{
+   delete m_thread;
+}
+
+void SimThreadPool::Worker::spawn()
+{
+   m_thread = _Thread::create(this);
+   m_thread->run();
+}
+
+void SimThreadPool::Worker::run()
+{
+   Sim()->getCoreManager()->registerSimWorkerThread();
+   m_pool->m_worker_tls->setInt(m_id + 1);
+
+   // Set thread name for Sniper-in-Sniper simulations
+   String threadName = String("sim-pool-") + itostr(m_id);
+   SimSetThreadName(threadName.c_str());
+
+   LOG_PRINT("Sim thread pool worker starting...");
+
+   Sim()->getSimThreadManager()->simThreadStartCallback();
+
+   m_pool->work(m_id);
+
+   Sim()->getSimThreadManager()->simThreadExitCallback();
+
+   LOG_PRINT("Sim thread pool worker exiting");
+}
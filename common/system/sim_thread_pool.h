@@ -0,0 +1,86 @@
+#ifndef SIM_THREAD_POOL_H
+#define SIM_THREAD_POOL_H
+
+#include "_thread.h"
+#include "fixed_types.h"
+#include "lock.h"
+#include "network.h"
+
+#include <deque>
+#include <vector>
+
+class TLS;
+
+// A fixed number of sim threads that together service the networks of all simulated cores (general/sim_thread_pool),
+// rather than one sim thread per core, each blocking on its own transport queue.
+//
+// When a message is queued for a core that is not yet scheduled, the core is put on the run queue of the worker
+// that sent it (or the core's home worker, for messages sent by application threads). Workers take cores from
+// their own run queue first, steal from the other workers when it is empty, and sleep when there is no work at all.
+// A core is on at most one run queue, and serviced by at most one worker at a time, so its messages are still
+// handled one at a time and in the order in which they were sent.
+class SimThreadPool
+{
+   public:
+      SimThreadPool(UInt32 num_workers);
+      ~SimThreadPool();
+
+      void spawn();
+
+   private:
+      class Worker : public Runnable
+      {
+         public:
+            Worker(SimThreadPool *pool, UInt32 id);
+            ~Worker();
+
+            void spawn();
+
+         private:
+            void run();
+
+            SimThreadPool *m_pool;
+            const UInt32 m_id;
+            _Thread *m_thread;
+      };
+
+      struct CoreState
+      {
+         SimThreadPool *pool;
+         core_id_t core_id;
+         Network *network;
+         Transport::Node *transport;
+         volatile UInt32 scheduled;
+      };
+
+      struct RunQueue
+      {
+         Lock lock;
+         std::deque<core_id_t> cores;
+      };
+
+      const UInt32 m_num_workers;
+      const UInt32 m_num_cores;
+      std::vector<CoreState> m_cores;
+      std::vector<RunQueue*> m_run_queues;
+      std::vector<Worker*> m_workers;
+      TLS *m_worker_tls; // Worker id + 1 of the current thread, 0 on threads that are not in the pool
+
+      volatile SInt32 m_num_queued;
+      volatile UInt32 m_num_running_cores;
+      volatile bool m_done;
+      volatile UInt32 m_num_sleeping;
+      volatile UInt32 m_wake_futex;
+
+      static void notifyFunc(void *arg);
+      static void terminateFunc(void *arg, NetPacket pkt);
+
+      void schedule(core_id_t core_id);
+      core_id_t take(UInt32 worker);
+      void service(core_id_t core_id);
+      void work(UInt32 worker);
+      void sleep();
+      void wake(UInt32 count);
+};
+
+#endif // SIM_THREAD_POOL_H
@@ -19,6 +19,7 @@
 #include "hooks_manager.h"
 #include "sampling_manager.h"
 #include "fault_injection.h"
+#include "approx_table.h"
 #include "routine_tracer.h"
 #include "instruction.h"
 #include "config.hpp"
@@ -74,6 +75,7 @@ Simulator::Simulator()
    , m_faultinjection_manager(NULL)
    , m_rtn_tracer(NULL)
    , m_memory_tracker(NULL)
+   , m_approx_table(NULL)
    , m_running(false)
    , m_inst_mode_output(true)
 {
@@ -90,6 +92,9 @@ void Simulator::start()
    m_transport = Transport::create();
    m_dvfs_manager = new DvfsManager();
    m_faultinjection_manager = FaultinjectionManager::create();
+   //AMHM Start
+   m_approx_table = new ApproxTable(m_config.getTotalCores());
+   //AMHM End
    m_thread_stats_manager = new ThreadStatsManager();
    m_clock_skew_minimization_manager = ClockSkewMinimizationManager::create();
    m_clock_skew_minimization_server = ClockSkewMinimizationServer::create();
@@ -148,18 +153,6 @@ void Simulator::start()
    }
 
    m_running = true;
-   
-   //AMHM Start
-   approx_table_entry = -1;
-   for( int i = 0; i < approx_table_max_entry; i++) {
-       approx_table[i].start_address = 0;
-       approx_table[i].end_address = 0;
-       approx_table[i].quality_level = 0;
-       approx_table[i].numberOfReads = 0;
-       approx_table[i].numberOfWrites = 0;
-       approx_table[i].numberOfInjectedFaults = 0;
-   }
-   //AMHM End
 }
 
 Simulator::~Simulator()
@@ -177,6 +170,11 @@ Simulator::~Simulator()
    m_stats_manager->recordStats("stop");
    m_hooks_manager->callHooks(HookType::HOOK_SIM_END, 0);
 
+   //AMHM Start
+   if (m_faultinjection_manager)
+      m_approx_table->saveStats(m_config.formatOutputFileName("AMHM_FI_stats.log"));
+   //AMHM End
+
    TotalTimer::reports();
 
    LOG_PRINT("Simulator dtor starting...");
@@ -210,6 +208,9 @@ Simulator::~Simulator()
    delete m_thread_manager;            m_thread_manager = NULL;
    delete m_thread_stats_manager;      m_thread_stats_manager = NULL;
    delete m_core_manager;              m_core_manager = NULL;
+   //AMHM Start
+   delete m_approx_table;              m_approx_table = NULL;
+   //AMHM End
    delete m_dvfs_manager;              m_dvfs_manager = NULL;
    delete m_magic_server;              m_magic_server = NULL;
    delete m_sync_server;               m_sync_server = NULL;
@@ -219,37 +220,6 @@ Simulator::~Simulator()
    delete m_transport;                 m_transport = NULL;
    delete m_stats_manager;             m_stats_manager = NULL;
 }
-//AMHM Start
-signed int Simulator::approx_table_search(IntPtr address) {
-    //printf("AMHM: Start Address Fed to search table: 0x%llx\n", start_address);
-    for(int i = 0; i < approx_table_max_entry; i++)
-               if((address >= (IntPtr) approx_table[i].start_address) && (address <= (IntPtr) approx_table[i].end_address))
-                   return i;
-    return -1;
-}
-
-double Simulator::get_error_rate(IntPtr address) {
-    //printf("AMHM: Start Address Fed to search table: 0x%llx\n", start_address);
-    for(int i = 0; i < approx_table_max_entry; i++)
-               if((address >= (IntPtr) approx_table[i].start_address) && (address <= (IntPtr) approx_table[i].end_address))
-                   return approx_table[i].quality_level;
-    return 0;
-}
-
-int Simulator::approx_table_del(unsigned long long int start_address) {
-    start_address = start_address + 0xD0;
-    start_address = start_address & 0xFFFFFFFFFFC0;
-    //printf("AMHM: Start Address Fed to search table: 0x%llx\n", start_address);
-    for(int i = 0; i < approx_table_max_entry; i++){
-               if(start_address == approx_table[i].start_address) {
-                   //printf("AMHM: Start Address %d in table: 0x%llx\n", i, Sim()->approx_table[i].start_address);
-                   return i;
-               }
-    }
-    return -1;
-}
-//AMHM End
-
 void Simulator::enablePerformanceModels()
 {
    if (Sim()->getFastForwardPerformanceManager() && InstMode::inst_mode_roi == InstMode::DETAILED)
@@ -5,10 +5,6 @@
 #include "log.h"
 #include "inst_mode.h"
 
-//AMHM Start
-#define approx_table_max_entry 100
-//AMHM End
-
 
 class _Thread;
 class SyscallServer;
@@ -32,6 +28,7 @@ class FaultinjectionManager;
 class TagsManager;
 class RoutineTracer;
 class MemoryTracker;
+class ApproxTable;
 namespace config { class Config; }
 
 class Simulator
@@ -83,20 +80,7 @@ public:
    InstMode::inst_mode_t getInstrumentationMode() { return InstMode::inst_mode; }
    
    //AMHM Start
-   struct approximation {
-       unsigned long long int start_address;
-       unsigned long long int end_address;
-       double quality_level;
-       UInt64 numberOfReads;
-       UInt64 numberOfWrites;
-       UInt64 numberOfInjectedFaults;
-   }approx_table[approx_table_max_entry];
-   signed int approx_table_search(IntPtr address);
-   double get_error_rate(IntPtr address);
-   int approx_table_del(unsigned long long int start_address);
-   int approx_table_entry;
-   long int numberOfL2Read;
-   long int numberOfL2Write;
+   ApproxTable *getApproxTable() { return m_approx_table; }
    //AMHM End
 
 private:
@@ -122,6 +106,9 @@ private:
    FaultinjectionManager *m_faultinjection_manager;
    RoutineTracer *m_rtn_tracer;
    MemoryTracker *m_memory_tracker;
+   //AMHM Start
+   ApproxTable *m_approx_table;
+   //AMHM End
 
    bool m_running;
    bool m_inst_mode_output;
@@ -237,6 +237,8 @@ SubsecondTime SyncServer::mutexUnlock(thread_id_t thread_id, carbon_mutex_t *mux
    SimMutex *psimmux = getMutex(mux, false);
 
    thread_id_t new_owner = psimmux->unlock(thread_id, time + m_reschedule_cost);
+   if (new_owner != SimMutex::NO_OWNER)
+      Sim()->getClockSkewMinimizationServer()->notifyInteraction();
 
    SubsecondTime new_time = time + (new_owner == SimMutex::NO_OWNER ? SubsecondTime::Zero() : m_reschedule_cost /* we had to call futex_wake */);
    return new_time;
@@ -282,6 +284,7 @@ SubsecondTime SyncServer::condSignal(thread_id_t thread_id, carbon_cond_t *cond,
    SimCond *psimcond = getCond(cond);
 
    psimcond->signal(thread_id, time);
+   Sim()->getClockSkewMinimizationServer()->notifyInteraction();
 
    return time;
 }
@@ -292,6 +295,7 @@ SubsecondTime SyncServer::condBroadcast(thread_id_t thread_id, carbon_cond_t *co
    SimCond *psimcond = getCond(cond);
 
    psimcond->broadcast(thread_id, time);
+   Sim()->getClockSkewMinimizationServer()->notifyInteraction();
 
    return time;
 }
@@ -308,6 +312,7 @@ SubsecondTime SyncServer::barrierWait(thread_id_t thread_id, carbon_barrier_t *b
 {
    ScopedLock sl(Sim()->getThreadManager()->getLock());
    SimBarrier *psimbarrier = &m_barriers[*barrier];
+   Sim()->getClockSkewMinimizationServer()->notifyInteraction();
 
    return psimbarrier->wait(thread_id, time);
 }
@@ -0,0 +1,271 @@
+#include "decode_cache.h"
+#include "shared_instruction_cache.h"
+#include "instruction.h"
+#include "micro_op.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "stats.h"
+#include "log.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <stdio.h>
+
+static const char decode_cache_magic[8] = { 'S', 'N', 'I', 'P', 'E', 'R', 'D', 'C' };
+
+DecodeCache::DecodeCache(String filename)
+   : m_filename(filename)
+   , m_data(NULL)
+   , m_length(0)
+   , m_syntax(Sim()->getCfg()->getString("general/syntax")[0])
+   , m_num_new_records(0)
+   , m_new_machine_mode(0)
+   , m_hits(0)
+   , m_misses(0)
+{
+   static_assert(sizeof(Header) % sizeof(UInt64) == 0 && sizeof(Record) % sizeof(UInt64) == 0 && sizeof(MicroOp) % sizeof(UInt64) == 0,
+                 "DecodeCache records must keep their MicroOps 8-byte aligned");
+#ifdef ENABLE_MICROOP_STRINGS
+   // MicroOps hold Strings, they cannot be copied to and from a file
+   LOG_PRINT_ERROR("traceinput/decode_cache is not supported with ENABLE_MICROOP_STRINGS");
+#endif
+
+   open();
+
+   registerStatsMetric("decode-cache", 0, "hits", &m_hits);
+   registerStatsMetric("decode-cache", 0, "misses", &m_misses);
+}
+
+DecodeCache::~DecodeCache()
+{
+   if (m_num_new_records)
+      write();
+   if (m_data)
+      munmap((void*)m_data, m_length);
+}
+
+void
+DecodeCache::open()
+{
+   int fd = ::open(m_filename.c_str(), O_RDONLY);
+   if (fd < 0)
+      return; // No cache yet, it will be created when we're done
+
+   struct stat st;
+   if (fstat(fd, &st) == 0 && UInt64(st.st_size) >= sizeof(Header))
+   {
+      void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+         m_data = (const char *)data;
+         m_length = st.st_size;
+      }
+   }
+   close(fd);
+
+   if (!m_data)
+   {
+      LOG_PRINT_WARNING("Cannot read decode cache %s, ignoring", m_filename.c_str());
+      return;
+   }
+
+   Header expected;
+   initHeader(&expected, 0, 0, 0);
+   const Header *header = (const Header *)m_data;
+   if (memcmp(header->magic, expected.magic, sizeof(expected.magic)) != 0
+       || header->version != expected.version
+       || header->uop_size != expected.uop_size
+       || header->num_iclass != expected.num_iclass
+       || header->num_reg != expected.num_reg
+       || header->num_buckets == 0 || (header->num_buckets & (header->num_buckets - 1)) != 0
+       || sizeof(Header) + header->num_buckets * sizeof(UInt64) > m_length)
+   {
+      LOG_PRINT_WARNING("Decode cache %s was written by a different version of Sniper, ignoring", m_filename.c_str());
+      munmap((void*)m_data, m_length);
+      m_data = NULL;
+      m_length = 0;
+   }
+}
+
+void
+DecodeCache::initHeader(Header *header, UInt64 num_buckets, UInt64 num_records, UInt8 machine_mode)
+{
+   memset(header, 0, sizeof(*header));
+   memcpy(header->magic, decode_cache_magic, sizeof(header->magic));
+   header->version = VERSION;
+   header->uop_size = sizeof(MicroOp);
+   header->num_iclass = XED_ICLASS_LAST;
+   header->num_reg = XED_REG_LAST;
+   header->num_buckets = num_buckets;
+   header->num_records = num_records;
+   header->machine_mode = machine_mode;
+}
+
+UInt64
+DecodeCache::recordSize(const Record *record)
+{
+   return sizeof(Record) + record->num_uops * sizeof(MicroOp);
+}
+
+bool
+DecodeCache::matches(const Record *record, UInt64 code_hash, const uint8_t *code, UInt32 size, UInt8 machine_mode)
+{
+   return record->code_hash == code_hash && record->size == size && record->machine_mode == machine_mode && memcmp(record->code, code, size) == 0;
+}
+
+const DecodeCache::Record*
+DecodeCache::find(UInt64 code_hash, const uint8_t *code, UInt32 size, UInt8 machine_mode) const
+{
+   const Header *header = (const Header *)m_data;
+   const UInt64 *buckets = (const UInt64 *)(header + 1);
+   const UInt64 mask = header->num_buckets - 1;
+   for(UInt64 index = code_hash & mask; buckets[index] != 0; index = (index + 1) & mask)
+   {
+      const Record *record = (const Record *)(m_data + buckets[index]);
+      if (matches(record, code_hash, code, size, machine_mode))
+         return record;
+   }
+   return NULL;
+}
+
+bool
+DecodeCache::lookup(const uint8_t *code, UInt32 size, IntPtr address, UInt8 machine_mode, Instruction *instruction)
+{
+   // A file written for the other machine mode is not used at all
+   const Record *record = m_data && ((const Header *)m_data)->machine_mode == machine_mode
+                        ? find(SharedInstructionCache::hashCode(code, size), code, size, machine_mode) : NULL;
+   if (!record)
+   {
+      __sync_fetch_and_add(&m_misses, 1);
+      return false;
+   }
+   __sync_fetch_and_add(&m_hits, 1);
+
+   std::vector<const MicroOp*> *uops = new std::vector<const MicroOp*>();
+   const MicroOp *cached = (const MicroOp *)(record + 1);
+   for(UInt32 i = 0; i < record->num_uops; ++i)
+   {
+      MicroOp *uop = new MicroOp(cached[i]);
+      uop->setInstructionPointer(Memory::make_access(address));
+      uop->setInstruction(instruction);
+      uops->push_back(uop);
+   }
+   instruction->setMicroOps(uops);
+
+   // Disassembly includes absolute branch targets, only use it at the address it was made for
+   if (record->address == address && record->syntax == m_syntax)
+      instruction->setDisassembly(record->disassembly);
+
+   return true;
+}
+
+void
+DecodeCache::insert(const uint8_t *code, UInt32 size, IntPtr address, UInt8 machine_mode, const Instruction *instruction)
+{
+   const std::vector<const MicroOp*> *uops = instruction->getMicroOps();
+   LOG_ASSERT_ERROR(size <= sizeof(Record::code) && uops->size() < 256, "Instruction too large for the decode cache");
+
+   ScopedLock sl(m_lock);
+
+   // The file holds a single machine mode, the one of the first instruction we see.
+   // Instructions of traces in the other mode (if a run mixes them) are not cached.
+   if (m_num_new_records == 0)
+      m_new_machine_mode = machine_mode;
+   else if (machine_mode != m_new_machine_mode)
+      return;
+
+   UInt64 offset = m_new_records.size();
+   m_new_records.resize(offset + sizeof(Record) + uops->size() * sizeof(MicroOp));
+   Record *record = (Record *)&m_new_records[offset];
+   memset(record, 0, sizeof(Record));
+   record->code_hash = SharedInstructionCache::hashCode(code, size);
+   record->address = address;
+   record->size = size;
+   record->num_uops = uops->size();
+   memcpy(record->code, code, size);
+   strncpy(record->disassembly, instruction->getDisassembly().c_str(), sizeof(record->disassembly) - 1);
+   record->syntax = m_syntax;
+   record->machine_mode = machine_mode;
+
+   MicroOp *cached = (MicroOp *)(record + 1);
+   for(UInt32 i = 0; i < uops->size(); ++i)
+   {
+      // Only store what does not depend on the instruction's location in this run
+      MicroOp uop(*(*uops)[i]);
+      uop.setInstructionPointer(Memory::make_access(0));
+      uop.setInstruction(NULL);
+      memcpy(&cached[i], &uop, sizeof(MicroOp));
+   }
+
+   ++m_num_new_records;
+}
+
+void
+DecodeCache::write()
+{
+   // Keep the records of the old file only if it is for the same machine mode
+   const char *old_data = m_data && ((const Header *)m_data)->machine_mode == m_new_machine_mode ? m_data : NULL;
+   UInt64 num_records = (old_data ? ((const Header *)old_data)->num_records : 0) + m_num_new_records;
+   UInt64 num_buckets = 16;
+   while (num_buckets < 2 * num_records)
+      num_buckets <<= 1;
+   const UInt64 records_start = sizeof(Header) + num_buckets * sizeof(UInt64);
+
+   // Rebuild the table with all records from the old file and from this run. Different threads
+   // (or applications) may have inserted the same instruction, only the first copy is kept.
+   std::vector<UInt64> buckets(num_buckets, 0);
+   std::vector<char> records;
+
+   const char *sources[2] = { old_data, m_new_records.empty() ? NULL : &m_new_records[0] };
+   const UInt64 starts[2] = { old_data ? sizeof(Header) + ((const Header *)old_data)->num_buckets * sizeof(UInt64) : 0, 0 };
+   const UInt64 ends[2] = { m_length, m_new_records.size() };
+
+   num_records = 0;
+   for(UInt32 source = 0; source < 2; ++source)
+   {
+      if (!sources[source])
+         continue;
+      for(UInt64 offset = starts[source]; offset < ends[source]; )
+      {
+         const Record *record = (const Record *)(sources[source] + offset);
+         const UInt64 size = recordSize(record);
+         offset += size;
+
+         UInt64 index = record->code_hash & (num_buckets - 1);
+         for(; buckets[index] != 0; index = (index + 1) & (num_buckets - 1))
+         {
+            if (matches((const Record *)&records[buckets[index] - records_start], record->code_hash, record->code, record->size, record->machine_mode))
+               break;
+         }
+         if (buckets[index] != 0)
+            continue; // Duplicate
+
+         buckets[index] = records_start + records.size();
+         records.insert(records.end(), (const char *)record, (const char *)record + size);
+         ++num_records;
+      }
+   }
+
+   Header header;
+   initHeader(&header, num_buckets, num_records, m_new_machine_mode);
+
+   // Write to a temporary file and rename it over the old one, so concurrent simulations never see a partial file
+   String tmpname = m_filename + ".tmp." + itostr(getpid());
+   FILE *fp = fopen(tmpname.c_str(), "wb");
+   bool ok = fp != NULL;
+   if (fp)
+   {
+      ok = fwrite(&header, sizeof(header), 1, fp) == 1
+         && fwrite(&buckets[0], buckets.size() * sizeof(UInt64), 1, fp) == 1
+         && (records.empty() || fwrite(&records[0], records.size(), 1, fp) == 1);
+      ok = (fclose(fp) == 0) && ok;
+   }
+   if (!ok || rename(tmpname.c_str(), m_filename.c_str()) != 0)
+   {
+      LOG_PRINT_WARNING("Cannot write decode cache %s", m_filename.c_str());
+      unlink(tmpname.c_str());
+   }
+}
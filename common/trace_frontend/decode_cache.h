@@ -0,0 +1,84 @@
+#ifndef __DECODE_CACHE_H
+#define __DECODE_CACHE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+#include <vector>
+
+class Instruction;
+
+// Micro-op decompositions of static instructions, kept on disk so repeated runs of the same trace
+// (e.g. a parameter sweep) do not have to decode their instructions again (traceinput/decode_cache).
+//
+// The file is memory-mapped read-only at startup, lookups are lock-free. Records are keyed by the instruction's
+// code bytes, and hold the MicroOps (with the instruction pointer and Instruction stripped) and the disassembly.
+// Instructions that were not found are collected in memory, at the end of the simulation a new file is written
+// holding both the old and new records, and is atomically renamed over the old one.
+// The same bytes decode differently in 32 and 64-bit mode (e.g. 0x40-0x4f are INC/DEC or REX prefixes),
+// so a file only holds records of one machine mode, which is part of the key and is recorded in the header.
+// A file for the other mode is not used, and is replaced with one for the mode of this run's new records.
+// Files written by a build with a different MicroOp layout or XED version are ignored (and replaced).
+class DecodeCache
+{
+   public:
+      DecodeCache(String filename);
+      ~DecodeCache();
+
+      // On a hit, set the instruction's micro-ops, and its disassembly when it was decoded at the same address
+      bool lookup(const uint8_t *code, UInt32 size, IntPtr address, UInt8 machine_mode, Instruction *instruction);
+      // Add a newly decoded instruction, it will be written out at the end of the simulation
+      void insert(const uint8_t *code, UInt32 size, IntPtr address, UInt8 machine_mode, const Instruction *instruction);
+
+   private:
+      static const UInt32 VERSION = 2;
+
+      struct Header
+      {
+         char magic[8];
+         UInt32 version;
+         UInt32 uop_size;
+         UInt32 num_iclass;
+         UInt32 num_reg;
+         UInt64 num_buckets;   // Hash table of record offsets follows the header, 0 marks an empty bucket
+         UInt64 num_records;
+         UInt32 machine_mode;  // xed_machine_mode_enum_t of all records
+         UInt32 padding;
+      };
+
+      struct Record
+      {
+         UInt64 code_hash;
+         UInt64 address;       // Address the disassembly was made for
+         UInt8 size;
+         UInt8 num_uops;       // Followed by num_uops MicroOps
+         UInt8 code[16];
+         char disassembly[64];
+         char syntax;          // First letter of general/syntax used for the disassembly
+         UInt8 machine_mode;
+         UInt8 padding[4];
+      };
+
+      const String m_filename;
+      // Memory-mapped file, or NULL if there is no (usable) cache file
+      const char *m_data;
+      UInt64 m_length;
+      const char m_syntax;
+
+      Lock m_lock;
+      std::vector<char> m_new_records;
+      UInt64 m_num_new_records;
+      UInt8 m_new_machine_mode;  // Machine mode of m_new_records, set by the first insert()
+
+      UInt64 m_hits;
+      UInt64 m_misses;
+
+      static UInt64 recordSize(const Record *record);
+      static bool matches(const Record *record, UInt64 code_hash, const uint8_t *code, UInt32 size, UInt8 machine_mode);
+      static void initHeader(Header *header, UInt64 num_buckets, UInt64 num_records, UInt8 machine_mode);
+      const Record* find(UInt64 code_hash, const uint8_t *code, UInt32 size, UInt8 machine_mode) const;
+      void open();
+      void write();
+};
+
+#endif // __DECODE_CACHE_H
@@ -0,0 +1,108 @@
+#include "shared_instruction_cache.h"
+
+SharedInstructionCache::Table::Table(UInt64 _bits, Table *_prev)
+   : bits(_bits)
+   , mask((1ULL << _bits) - 1)
+   , slots(new Entry * volatile [1ULL << _bits])
+   , prev(_prev)
+{
+   for(UInt64 index = 0; index <= mask; ++index)
+      slots[index] = NULL;
+}
+
+SharedInstructionCache::Table::~Table()
+{
+   delete [] slots;
+}
+
+SharedInstructionCache::Entry*
+SharedInstructionCache::Table::find(IntPtr addr, UInt64 code_hash) const
+{
+   for(UInt64 index = hash(addr); ; index = (index + 1) & mask)
+   {
+      Entry *entry = __atomic_load_n(&slots[index], __ATOMIC_ACQUIRE);
+      if (entry == NULL)
+         return NULL;
+      else if (entry->addr == addr && entry->code_hash == code_hash)
+         return entry;
+   }
+}
+
+void
+SharedInstructionCache::Table::insert(Entry *entry)
+{
+   UInt64 index = hash(entry->addr);
+   while (slots[index] != NULL)
+      index = (index + 1) & mask;
+   // Publish the entry only after its contents are visible
+   __atomic_store_n(&slots[index], entry, __ATOMIC_RELEASE);
+}
+
+SharedInstructionCache::SharedInstructionCache(UInt64 capacity)
+   : m_size(0)
+{
+   UInt64 bits = 4;
+   while ((1ULL << bits) < 2 * capacity)
+      ++bits;
+   m_table = new Table(bits, NULL);
+}
+
+SharedInstructionCache::~SharedInstructionCache()
+{
+   for(UInt64 index = 0; index <= m_table->mask; ++index)
+      delete m_table->slots[index];
+   while (m_table)
+   {
+      Table *prev = m_table->prev;
+      delete m_table;
+      m_table = prev;
+   }
+}
+
+Instruction*
+SharedInstructionCache::find(IntPtr addr, UInt64 code_hash) const
+{
+   Table *table = __atomic_load_n(&m_table, __ATOMIC_ACQUIRE);
+   Entry *entry = table->find(addr, code_hash);
+   return entry ? entry->instruction : NULL;
+}
+
+Instruction*
+SharedInstructionCache::insert(IntPtr addr, UInt64 code_hash, Instruction *instruction)
+{
+   ScopedLock sl(m_lock);
+
+   Table *table = m_table;
+   if (Entry *entry = table->find(addr, code_hash))
+      return entry->instruction;
+
+   if (2 * (m_size + 1) > table->mask + 1)
+   {
+      // Readers may still be using the old table, it stays valid (but no longer receives new entries)
+      Table *grown = new Table(table->bits + 1, table);
+      for(UInt64 index = 0; index <= table->mask; ++index)
+         if (table->slots[index])
+            grown->insert(table->slots[index]);
+      __atomic_store_n(&m_table, grown, __ATOMIC_RELEASE);
+      table = grown;
+   }
+
+   Entry *entry = new Entry;
+   entry->addr = addr;
+   entry->code_hash = code_hash;
+   entry->instruction = instruction;
+   table->insert(entry);
+   ++m_size;
+
+   return instruction;
+}
+
+UInt64
+SharedInstructionCache::hashCode(const uint8_t *data, UInt32 size)
+{
+   // FNV-1a, seeded with the size so that instructions that are a prefix of each other differ
+   UInt64 hash = 0xcbf29ce484222325ULL ^ size;
+   for(UInt32 i = 0; i < size; ++i)
+      hash = (hash ^ data[i]) * 0x100000001b3ULL;
+   return hash;
+}
@@ -0,0 +1,59 @@
+#ifndef __SHARED_INSTRUCTION_CACHE_H
+#define __SHARED_INSTRUCTION_CACHE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+class Instruction;
+
+// Decoded instructions shared by all TraceThreads of one application.
+//
+// Each TraceThread keeps its own (unsynchronized) instruction cache, on a miss it looks here before decoding,
+// so threads that run the same code as an earlier thread do not decode it again.
+// Instructions are keyed on both their address and a hash of their code bytes, so code that is
+// replaced at the same address (JIT, reloaded libraries) does not return a stale decoding.
+//
+// Lookups are lock-free: entries are immutable once published, and when the table grows the old one is
+// kept around until the cache is destroyed, as other threads may still be probing it. Inserts take a lock.
+// Instructions themselves are never deleted, as with the per-thread caches.
+class SharedInstructionCache
+{
+   public:
+      SharedInstructionCache(UInt64 capacity = 4096);
+      ~SharedInstructionCache();
+
+      Instruction* find(IntPtr addr, UInt64 code_hash) const;
+      // Returns the cached instruction, which is not the one passed in if another thread inserted it first
+      Instruction* insert(IntPtr addr, UInt64 code_hash, Instruction *instruction);
+
+      static UInt64 hashCode(const uint8_t *data, UInt32 size);
+
+   private:
+      struct Entry
+      {
+         IntPtr addr;
+         UInt64 code_hash;
+         Instruction *instruction;
+      };
+
+      struct Table
+      {
+         Table(UInt64 bits, Table *prev);
+         ~Table();
+
+         const UInt64 bits;
+         const UInt64 mask;
+         Entry * volatile * const slots;
+         Table * const prev;
+
+         UInt64 hash(IntPtr addr) const { return (UInt64(addr) * 0x9E3779B97F4A7C15ULL) >> (64 - bits); }
+         Entry* find(IntPtr addr, UInt64 code_hash) const;
+         void insert(Entry *entry);
+      };
+
+      Table * volatile m_table;
+      UInt64 m_size;
+      Lock m_lock;
+};
+
+#endif // __SHARED_INSTRUCTION_CACHE_H
@@ -1,5 +1,7 @@
 #include "trace_manager.h"
 #include "trace_thread.h"
+#include "shared_instruction_cache.h"
+#include "decode_cache.h"
 #include "simulator.h"
 #include "thread_manager.h"
 #include "hooks_manager.h"
@@ -25,7 +27,12 @@ TraceManager::TraceManager()
    , m_app_info(m_num_apps)
    , m_tracefiles(m_num_apps)
    , m_responsefiles(m_num_apps)
+   , m_decode_cache(NULL)
 {
+   String decode_cache = Sim()->getCfg()->getString("traceinput/decode_cache");
+   if (decode_cache != "")
+      m_decode_cache = new DecodeCache(decode_cache);
+
    setupTraceFiles(0);
 }
 
@@ -119,9 +126,13 @@ thread_id_t TraceManager::newThread(app_id_t app_id, bool first, bool init_fifo,
          responsefile = getFifoName(app_id, thread_num, true /*response*/, true /*create*/);
    }
 
+   // Kept across restarts of the application, the code it runs does not change
+   if (!m_app_info[app_id].icache)
+      m_app_info[app_id].icache = new SharedInstructionCache();
+
    m_num_threads_running++;
    Thread *thread = Sim()->getThreadManager()->createThread(app_id, creator_thread_id);
-   TraceThread *tthread = new TraceThread(thread, time, tracefile, responsefile, app_id, init_fifo /*cleaup*/);
+   TraceThread *tthread = new TraceThread(thread, time, tracefile, responsefile, app_id, m_app_info[app_id].icache, init_fifo /*cleaup*/);
    m_threads.push_back(tthread);
 
    if (spawn)
@@ -228,6 +239,8 @@ void TraceManager::cleanup()
    m_threads.clear();
 
    m_num_threads_running = 0;
+   for(std::vector<app_info_t>::iterator it = m_app_info.begin(); it != m_app_info.end(); ++it)
+      delete it->icache;
    m_app_info.clear();
    m_app_info.resize(m_num_apps);
    m_num_apps_nonfinish = m_num_apps;
@@ -236,6 +249,7 @@ void TraceManager::cleanup()
 TraceManager::~TraceManager()
 {
    cleanup();
+   delete m_decode_cache;
 }
 
 void TraceManager::start()
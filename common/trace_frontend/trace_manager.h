@@ -9,6 +9,8 @@
 #include <vector>
 
 class TraceThread;
+class SharedInstructionCache;
+class DecodeCache;
 
 class TraceManager
 {
@@ -31,10 +33,12 @@ class TraceManager
             : thread_count(1)
             , num_threads(1)
             , num_runs(0)
+            , icache(NULL)
          {}
          UInt32 thread_count;       //< Index counter for new thread's FIFO name
          UInt32 num_threads;        //< Number of active threads for this app (when zero, app is done)
          UInt32 num_runs;           //< Number of completed runs
+         SharedInstructionCache *icache; //< Decoded instructions, shared by all threads of this app
       };
 
       Monitor *m_monitor;
@@ -51,6 +55,7 @@ class TraceManager
       std::vector<String> m_tracefiles;
       std::vector<String> m_responsefiles;
       String m_trace_prefix;
+      DecodeCache *m_decode_cache;
       Lock m_lock;
 
       String getFifoName(app_id_t app_id, UInt64 thread_num, bool response, bool create);
@@ -76,6 +81,8 @@ class TraceManager
       void endApplication(TraceThread *thread, SubsecondTime time);
       void accessMemory(int core_id, Core::lock_signal_t lock_signal, Core::mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size);
 
+      DecodeCache* getDecodeCache() const { return m_decode_cache; }
+
       UInt64 getProgressExpect();
       UInt64 getProgressValue();
 };
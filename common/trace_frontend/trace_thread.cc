@@ -9,6 +9,8 @@
 #include "dynamic_instruction.h"
 #include "performance_model.h"
 #include "instruction_decoder.h"
+#include "shared_instruction_cache.h"
+#include "decode_cache.h"
 #include "config.hpp"
 #include "syscall_model.h"
 #include "core.h"
@@ -29,15 +31,20 @@ extern "C" {
 }
 #endif
 
-TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, bool cleanup)
+TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, SharedInstructionCache *shared_icache, bool cleanup)
    : m__thread(NULL)
    , m_thread(thread)
    , m_time_start(time_start)
-   , m_trace(tracefile.c_str(), responsefile.c_str(), thread->getId())
+   , m_trace(tracefile.c_str(), responsefile.c_str(), thread->getId(), Sim()->getCfg()->getInt("traceinput/prefetch_blocks"))
    , m_trace_has_pa(false)
    , m_address_randomization(Sim()->getCfg()->getBool("traceinput/address_randomization"))
    , m_appid_from_coreid(Sim()->getCfg()->getString("scheduler/type") == "sequential" ? true : false)
    , m_stop(false)
+   , m_shared_icache(m_appid_from_coreid ? NULL : shared_icache)
+   , m_decode_cache(Sim()->getTraceManager()->getDecodeCache())
+   , m_batch_buffer(0)
+   , m_batch_pos(0)
+   , m_batch_count(0)
    , m_bbv_base(0)
    , m_bbv_count(0)
    , m_bbv_last(0)
@@ -51,6 +58,8 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    , m_started(false)
    , m_stopped(false)
 {
+   memset(m_icache_direct, 0, sizeof(m_icache_direct));
+
    m_trace.setHandleInstructionCountFunc(TraceThread::__handleInstructionCountFunc, this);
    m_trace.setHandleCacheOnlyFunc(TraceThread::__handleCacheOnlyFunc, this);
    if (Sim()->getCfg()->getBool("traceinput/mirror_output"))
@@ -203,6 +212,8 @@ void TraceThread::handleOutputFunc(uint8_t fd, const uint8_t *data, uint32_t siz
 
 uint64_t TraceThread::handleSyscallFunc(uint16_t syscall_number, const uint8_t *data, uint32_t size)
 {
+   drainPerformanceModel();
+
    // We may have been blocked in a system call, if we start executing instructions again that means we're continuing
    if (m_blocked)
    {
@@ -238,22 +249,26 @@ uint64_t TraceThread::handleSyscallFunc(uint16_t syscall_number, const uint8_t *
 
 int32_t TraceThread::handleNewThreadFunc()
 {
+   drainPerformanceModel();
    return Sim()->getTraceManager()->createThread(m_app_id, getCurrentTime(), m_thread->getId());
 }
 
 int32_t TraceThread::handleForkFunc()
 {
+   drainPerformanceModel();
    return Sim()->getTraceManager()->createApplication(getCurrentTime(), m_thread->getId());
 }
 
 int32_t TraceThread::handleJoinFunc(int32_t join_thread_id)
 {
+   drainPerformanceModel();
    Sim()->getThreadManager()->joinThread(m_thread->getId(), join_thread_id);
    return 0;
 }
 
 uint64_t TraceThread::handleMagicFunc(uint64_t a, uint64_t b, uint64_t c)
 {
+   drainPerformanceModel();
    return handleMagicInstruction(m_thread->getId(), a, b, c);
 }
 
@@ -277,6 +292,8 @@ void TraceThread::handleRoutineChangeFunc(Sift::RoutineOpType event, uint64_t ei
 
 bool TraceThread::handleEmuFunc(Sift::EmuType type, Sift::EmuRequest &req, Sift::EmuReply &res)
 {
+   drainPerformanceModel();
+
    // We may have been blocked in a system call, if we start executing instructions again that means we're continuing
    if (m_blocked)
    {
@@ -408,6 +425,11 @@ Instruction* TraceThread::decode(Sift::Instruction &inst)
    instruction->setAddress(va2pa(inst.sinst->addr));
    instruction->setSize(inst.sinst->size);
    instruction->setAtomic(xed_operand_values_get_atomic(xed_decoded_inst_operands_const(&xed_inst)));
+
+   if (m_decode_cache && m_decode_cache->lookup(inst.sinst->data, inst.sinst->size, inst.sinst->addr, m_trace.getMachineMode(), instruction)
+       && instruction->getDisassembly() != "")
+      return instruction;
+
    char disassembly[64];
 #if PIN_REV >= 67254
    xed_format_context(m_syntax, &xed_inst, disassembly, sizeof(disassembly) - 1, inst.sinst->addr, 0, 0);
@@ -416,14 +438,22 @@ Instruction* TraceThread::decode(Sift::Instruction &inst)
 #endif
    instruction->setDisassembly(disassembly);
 
-   const std::vector<const MicroOp*> *uops = InstructionDecoder::decode(inst.sinst->addr, &xed_inst, instruction);
-   instruction->setMicroOps(uops);
+   if (instruction->getMicroOps() == NULL)
+   {
+      const std::vector<const MicroOp*> *uops = InstructionDecoder::decode(inst.sinst->addr, &xed_inst, instruction);
+      instruction->setMicroOps(uops);
+
+      if (m_decode_cache)
+         m_decode_cache->insert(inst.sinst->data, inst.sinst->size, inst.sinst->addr, m_trace.getMachineMode(), instruction);
+   }
 
    return instruction;
 }
 
 Sift::Mode TraceThread::handleInstructionCountFunc(uint32_t icount)
 {
+   drainPerformanceModel();
+
    if (!m_started)
    {
       // Received first instruction, let TraceManager know our SIFT connection is up and running
@@ -595,15 +625,47 @@ void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruc
    }
 }
 
+Instruction* TraceThread::getInstruction(Sift::Instruction &inst)
+{
+   IntPtr addr = inst.sinst->addr;
+   UInt32 index = (addr ^ (addr >> ICACHE_DIRECT_BITS)) & ((1 << ICACHE_DIRECT_BITS) - 1);
+   if (m_icache_direct[index].ins && m_icache_direct[index].addr == addr)
+      return m_icache_direct[index].ins;
+
+   Instruction* &ins = m_icache[addr];
+   if (ins == NULL)
+   {
+      if (m_shared_icache)
+      {
+         UInt64 code_hash = SharedInstructionCache::hashCode(inst.sinst->data, inst.sinst->size);
+         ins = m_shared_icache->find(addr, code_hash);
+         if (ins == NULL)
+         {
+            Instruction *decoded = decode(inst);
+            ins = m_shared_icache->insert(addr, code_hash, decoded);
+            if (ins != decoded)
+               delete decoded; // Another thread was first (this also frees our micro-ops)
+         }
+         // Another thread's decoding is only usable if it maps the instruction to the same physical address
+         if (ins->getAddress() != va2pa(addr))
+            ins = decode(inst);
+      }
+      else
+         ins = decode(inst);
+   }
+
+   m_icache_direct[index].addr = addr;
+   m_icache_direct[index].ins = ins;
+   return ins;
+}
+
 void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instruction &next_inst, PerformanceModel *prfmdl)
 {
    const xed_decoded_inst_t &xed_inst = inst.sinst->xed_inst;
 
    // Set up instruction
 
-   if (m_icache.count(inst.sinst->addr) == 0)
-      m_icache[inst.sinst->addr] = decode(inst);
-   Instruction *ins = m_icache[inst.sinst->addr];
+   Instruction *ins = getInstruction(inst);
    DynamicInstruction *dynins = prfmdl->createDynamicInstruction(ins, va2pa(inst.sinst->addr));
 
    // Add dynamic instruction info
@@ -674,6 +736,14 @@ void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instru
    }
 }
 
+// With ENABLE_PERF_MODEL_OWN_THREAD, wait for the core thread to simulate all instructions we queued,
+// before handling events that read or update the core's time
+void TraceThread::drainPerformanceModel()
+{
+   if (m_thread->getCore())
+      m_thread->getCore()->getPerformanceModel()->drain();
+}
+
 void TraceThread::unblock()
 {
    LOG_ASSERT_ERROR(m_blocked == true, "Must call only when m_blocked == true");
@@ -702,6 +772,19 @@ void TraceThread::unblock()
    m_blocked = false;
 }
 
+Sift::Instruction* TraceThread::nextInstruction()
+{
+   if (m_batch_pos == m_batch_count)
+   {
+      m_batch_buffer ^= 1;
+      m_batch_count = m_trace.ReadBatch(m_batch[m_batch_buffer], BATCH_SIZE);
+      m_batch_pos = 0;
+      if (m_batch_count == 0)
+         return NULL;
+   }
+   return &m_batch[m_batch_buffer][m_batch_pos++];
+}
+
 void TraceThread::run()
 {
    // Set thread name for Sniper-in-Sniper simulations
@@ -724,14 +807,14 @@ void TraceThread::run()
    Core *core = m_thread->getCore();
    PerformanceModel *prfmdl = core->getPerformanceModel();
 
-   Sift::Instruction inst, next_inst;
+   Sift::Instruction *inst = nextInstruction(), *next_inst;
 
-   bool have_first = m_trace.Read(inst);
+   bool have_first = inst != NULL;
    // Received first instruction, let TraceManager know our SIFT connection is up and running
    Sim()->getTraceManager()->signalStarted();
    m_started = true;
 
-   while(have_first && m_trace.Read(next_inst))
+   while(have_first && (next_inst = nextInstruction()) != NULL)
    {
       if (m_blocked)
       {
@@ -746,7 +829,7 @@ void TraceThread::run()
 
       // Reconstruct and count basic blocks
 
-      if (m_bbv_end || m_bbv_last != inst.sinst->addr)
+      if (m_bbv_end || m_bbv_last != inst->sinst->addr)
       {
          // We're the start of a new basic block
          core->countInstructions(m_bbv_base, m_bbv_count);
@@ -758,13 +841,13 @@ void TraceThread::run()
             icache_warmup_size = m_bbv_last - m_bbv_base;
          }
          // Set up new basic block info
-         m_bbv_base = inst.sinst->addr;
+         m_bbv_base = inst->sinst->addr;
          m_bbv_count = 0;
       }
       m_bbv_count++;
-      m_bbv_last = inst.sinst->addr + inst.sinst->size;
+      m_bbv_last = inst->sinst->addr + inst->sinst->size;
       // Force BBV end on non-taken branches
-      m_bbv_end = inst.is_branch;
+      m_bbv_end = inst->is_branch;
 
 
       switch(Sim()->getInstrumentationMode())
@@ -773,11 +856,11 @@ void TraceThread::run()
             break;
 
          case InstMode::CACHE_ONLY:
-            handleInstructionWarmup(inst, next_inst, core, do_icache_warmup, icache_warmup_addr, icache_warmup_size);
+            handleInstructionWarmup(*inst, *next_inst, core, do_icache_warmup, icache_warmup_addr, icache_warmup_size);
             break;
 
          case InstMode::DETAILED:
-            handleInstructionDetailed(inst, next_inst, prfmdl);
+            handleInstructionDetailed(*inst, *next_inst, prfmdl);
             break;
 
          default:
@@ -788,9 +871,11 @@ void TraceThread::run()
       // We may have been rescheduled to a different core
       // by prfmdl->iterate (in handleInstructionDetailed),
       // or core->countInstructions (when using a fast-forward performance model)
-      SubsecondTime time = prfmdl->getElapsedTime();
-      if (m_thread->reschedule(time, core))
+      if (m_thread->getCore() != core)
       {
+         prfmdl->drain();
+         SubsecondTime time = prfmdl->getElapsedTime();
+         m_thread->reschedule(time, core);
          core = m_thread->getCore();
          prfmdl = core->getPerformanceModel();
       }
@@ -804,6 +889,7 @@ void TraceThread::run()
 
    printf("[TRACE:%u] -- %s --\n", m_thread->getId(), m_stop ? "STOP" : "DONE");
 
+   prfmdl->drain();
    SubsecondTime time_end = prfmdl->getElapsedTime();
 
    Sim()->getThreadManager()->onThreadExit(m_thread->getId());
@@ -7,8 +7,8 @@
 #include "core.h"
 #include "sift_reader.h"
 #include "operand.h"
+#include "flat_hash_map.h"
 
-#include <unordered_map>
 
 #define NUM_PAPI_COUNTERS 6
 
@@ -21,6 +21,8 @@
 
 class Instruction;
 class DynamicInstruction;
+class SharedInstructionCache;
+class DecodeCache;
 
 class TraceThread : public Runnable
 {
@@ -52,7 +54,19 @@ class TraceThread : public Runnable
       bool m_appid_from_coreid;
       uint8_t m_address_randomization_table[256];
       bool m_stop;
-      std::unordered_map<IntPtr, Instruction *> m_icache;
+      FlatHashMap<IntPtr, Instruction *> m_icache;
+      // Application-wide cache behind m_icache, NULL when instruction addresses depend on the core we run on
+      SharedInstructionCache *m_shared_icache;
+      // Micro-op decodings from earlier runs, NULL if traceinput/decode_cache is not set
+      DecodeCache *m_decode_cache;
+      // Direct-mapped cache in front of m_icache
+      static const UInt32 ICACHE_DIRECT_BITS = 10;
+      struct { IntPtr addr; Instruction *ins; } m_icache_direct[1 << ICACHE_DIRECT_BITS];
+      // Instructions are read from the trace in batches, alternating between two buffers
+      // so the previous instruction stays valid while the next batch is read
+      static const UInt32 BATCH_SIZE = 64;
+      Sift::Instruction m_batch[2][BATCH_SIZE];
+      UInt32 m_batch_buffer, m_batch_pos, m_batch_count;
       UInt64 m_bbv_base;
       UInt64 m_bbv_count;
       UInt64 m_bbv_last;
@@ -103,11 +117,14 @@ class TraceThread : public Runnable
       void handleRoutineChangeFunc(Sift::RoutineOpType event, uint64_t eip, uint64_t esp, uint64_t callEip);
       void handleRoutineAnnounceFunc(uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename);
 
+      Sift::Instruction* nextInstruction();
       Instruction* decode(Sift::Instruction &inst);
+      Instruction* getInstruction(Sift::Instruction &inst);
       void handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size);
       void handleInstructionDetailed(Sift::Instruction &inst, Sift::Instruction &next_inst, PerformanceModel *prfmdl);
       void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const xed_decoded_inst_t &xed_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
       void unblock();
+      void drainPerformanceModel();
 
       SubsecondTime getCurrentTime() const;
 
@@ -116,7 +133,7 @@ class TraceThread : public Runnable
    public:
       bool m_stopped;
 
-      TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, bool cleanup);
+      TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, SharedInstructionCache *shared_icache, bool cleanup);
       ~TraceThread();
 
       void spawn();
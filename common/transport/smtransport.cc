@@ -23,6 +23,9 @@ SmTransport::~SmTransport()
 
    delete [] m_core_nodes;
    delete m_global_node;
+
+   for(std::vector<SlabPool*>::iterator it = m_pools.begin(); it != m_pools.end(); ++it)
+      delete *it;
 }
 
 Transport::Node* SmTransport::createNode(core_id_t core_id)
@@ -56,6 +59,19 @@ SmTransport::SmNode* SmTransport::getNodeFromId(core_id_t core_id)
    return m_core_nodes[core_id];
 }
 
+void SmTransport::freeBuffer(Byte *buffer)
+{
+   SlabPool::free(buffer);
+}
+
+SlabPool* SmTransport::createPool()
+{
+   // Nodes are created while the simulator is set up, from a single thread
+   SlabPool *pool = new SlabPool(BUFFER_SIZE, BUFFERS_PER_SLAB);
+   m_pools.push_back(pool);
+   return pool;
+}
+
 void SmTransport::clearNodeForId(core_id_t core_id)
 {
    // This is called upon deletion of the node, so we should simply
@@ -68,7 +84,10 @@ void SmTransport::clearNodeForId(core_id_t core_id)
 
 SmTransport::SmNode::SmNode(core_id_t core_id, SmTransport *smt)
    : Node(core_id)
+   , m_notify_func(NULL)
+   , m_notify_arg(NULL)
    , m_smt(smt)
+   , m_pool(smt->createPool())
 {
 }
 
@@ -81,61 +100,65 @@ SmTransport::SmNode::~SmNode()
 void SmTransport::SmNode::globalSend(SInt32 dest_proc, const void *buffer, UInt32 length)
 {
    LOG_ASSERT_ERROR(dest_proc == 0, "Destination other than zero: %d", dest_proc);
-   send((SmNode*)m_smt->getGlobalNode(), buffer, length);
+   Byte *data = allocBuffer(length);
+   memcpy(data, buffer, length);
+   sendBuffer((SmNode*)m_smt->getGlobalNode(), data, length);
 }
 
 void SmTransport::SmNode::send(SInt32 dest_id, const void* buffer, UInt32 length)
+{
+   Byte *data = allocBuffer(length);
+   memcpy(data, buffer, length);
+   sendBuffer(dest_id, data, length);
+}
+
+UInt32 SmTransport::SmNode::getTrailerOffset(UInt32 length)
+{
+   return (length + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+}
+
+Byte* SmTransport::SmNode::allocBuffer(UInt32 length)
+{
+   return m_pool->alloc(getTrailerOffset(length) + sizeof(Trailer));
+}
+
+void SmTransport::SmNode::sendBuffer(SInt32 dest_id, Byte *buffer, UInt32 length)
 {
    SmNode *dest_node = m_smt->getNodeFromId(dest_id);
    LOG_ASSERT_ERROR(dest_node != NULL, "Attempt to send to non-existent node: %d", dest_id);
-   send(dest_node, buffer, length);
+   sendBuffer(dest_node, buffer, length);
 }
 
-void SmTransport::SmNode::send(SmNode *dest_node, const void *buffer, UInt32 length)
+void SmTransport::SmNode::sendBuffer(SmNode *dest_node, Byte *buffer, UInt32 length)
 {
-   Byte *data = new Byte[length];
-   memcpy(data, buffer, length);
+   LOG_PRINT("sending msg -- size: %i, data: %p, dest: %p", length, buffer, dest_node);
 
-   LOG_PRINT("sending msg -- size: %i, data: %p, dest: %p", length, data, dest_node);
+   Trailer *trailer = (Trailer*)(buffer + getTrailerOffset(length));
+   trailer->buffer = buffer;
+   dest_node->m_queue.push(&trailer->link);
 
-   dest_node->m_lock.acquire();
-   dest_node->m_queue.push(data);
-   dest_node->m_lock.release();
-   dest_node->m_cond.broadcast();
+   if (dest_node->m_notify_func)
+      dest_node->m_notify_func(dest_node->m_notify_arg);
 }
 
 Byte* SmTransport::SmNode::recv()
 {
    LOG_PRINT("attempting recv -- this: %p", this);
 
-   m_lock.acquire();
-
-   while (true)
-   {
-      if (!m_queue.empty())
-      {
-         Byte *data = m_queue.front();
-         m_queue.pop();
-         m_lock.release();
+   Byte *data = ((Trailer*)m_queue.pop())->buffer;
 
-         LOG_PRINT("msg recv'd -- data: %p, this: %p", data, this);
+   LOG_PRINT("msg recv'd -- data: %p, this: %p", data, this);
 
-         return data;
-      }
-      else
-      {
-         m_cond.wait(m_lock);
-      }
-   }
+   return data;
 }
 
 bool SmTransport::SmNode::query()
 {
-   bool result = false;
-
-   m_lock.acquire();
-   result = !m_queue.empty();
-   m_lock.release();
+   return !m_queue.empty();
+}
 
-   return result;
+void SmTransport::SmNode::setNotify(NotifyFunc func, void *arg)
+{
+   m_notify_arg = arg;
+   m_notify_func = func;
 }
@@ -1,10 +1,11 @@
 #ifndef SMTRANSPORT_H
 #define SMTRANSPORT_H
 
-#include <queue>
-
 #include "transport.h"
-#include "cond.h"
+#include "mpsc_queue.h"
+#include "slab_pool.h"
+
+#include <vector>
 
 class SmTransport : public Transport
 {
@@ -20,16 +21,29 @@ public:
 
       void globalSend(SInt32, const void*, UInt32);
       void send(core_id_t, const void*, UInt32);
+      Byte* allocBuffer(UInt32);
+      void sendBuffer(core_id_t, Byte*, UInt32);
       Byte* recv();
       bool query();
+      void setNotify(NotifyFunc, void*);
 
    private:
-      void send(SmNode *dest, const void *buffer, UInt32 length);
+      // Messages are passed by pointer, the queue link is stored behind the data
+      // so the receiver can free the message with a single freeBuffer() of the data
+      struct Trailer
+      {
+         MPSCQueue::Link link;
+         Byte *buffer;
+      };
+
+      static UInt32 getTrailerOffset(UInt32 length);
+      void sendBuffer(SmNode *dest, Byte *buffer, UInt32 length);
 
-      std::queue<Byte*> m_queue;
-      Lock m_lock;
-      ConditionVariable m_cond;
+      MPSCQueue m_queue;
+      NotifyFunc m_notify_func;
+      void *m_notify_arg;
       SmTransport *m_smt;
+      SlabPool *m_pool;
    };
 
    Node* createNode(core_id_t core_id);
@@ -37,12 +51,22 @@ public:
    void barrier();
    Node* getGlobalNode();
 
+   void freeBuffer(Byte *buffer);
+
 private:
+   // Buffers big enough for a coherence message carrying a cache line, including the NetPacket header and Trailer
+   static const UInt32 BUFFER_SIZE = 256;
+   static const UInt32 BUFFERS_PER_SLAB = 256;
+
    Node *m_global_node;
    SmNode **m_core_nodes;
+   // One pool per node, so nodes only contend with their own senders.
+   // Owned by the transport rather than the nodes, buffers may outlive the node that sent them
+   std::vector<SlabPool*> m_pools;
 
    SmNode *getNodeFromId(core_id_t core_id);
    void clearNodeForId(core_id_t core_id);
+   SlabPool *createPool();
 };
 
 #endif
@@ -17,9 +17,18 @@ public:
 
       virtual void globalSend(SInt32 dest_proc, const void *buffer, UInt32 length) = 0;
       virtual void send(core_id_t dest, const void *buffer, UInt32 length) = 0;
+      // Zero-copy send: buffer comes from allocBuffer(length), ownership passes to the receiver
+      virtual Byte* allocBuffer(UInt32 length) = 0;
+      virtual void sendBuffer(core_id_t dest, Byte *buffer, UInt32 length) = 0;
+      // Returned buffers are owned by the caller, and freed with Transport::freeBuffer()
       virtual Byte* recv() = 0;
       virtual bool query() = 0;
 
+      // Call func(arg) after each message that is queued for this node,
+      // for nodes that are not serviced by a thread blocking in recv()
+      typedef void (*NotifyFunc)(void *arg);
+      virtual void setNotify(NotifyFunc func, void *arg) = 0;
+
    protected:
       core_id_t getCoreId();
       Node(core_id_t core_id);
@@ -36,6 +45,9 @@ public:
    virtual void barrier() = 0;
    virtual Node* getGlobalNode() = 0; // for communication not linked to a core
 
+   // Free a buffer returned by Node::recv(), can be called from any thread
+   virtual void freeBuffer(Byte *buffer) = 0;
+
 protected:
    Transport();
 
@@ -9,6 +9,9 @@ KNOB<UINT64> KnobDetailedTarget(KNOB_MODE_WRITEONCE, "pintool", "d", "0", "instr
 KNOB<UINT64> KnobUseResponseFiles(KNOB_MODE_WRITEONCE, "pintool", "r", "0", "use response files (required for multithreaded applications or when emulating syscalls, default = 0)");
 KNOB<UINT64> KnobEmulateSyscalls(KNOB_MODE_WRITEONCE, "pintool", "e", "0", "emulate syscalls (required for multithreaded applications, default = 0)");
 KNOB<BOOL>   KnobSendPhysicalAddresses(KNOB_MODE_WRITEONCE, "pintool", "pa", "0", "send logical to physical address mapping");
+KNOB<BOOL>   KnobCompressionFramed(KNOB_MODE_WRITEONCE, "pintool", "zframed", "0", "compress in independent blocks (framed SIFT), default = 0");
+KNOB<UINT64> KnobCompressionLevel(KNOB_MODE_WRITEONCE, "pintool", "zlevel", "9", "zlib compression level for framed compression (1-9, default = 9)");
+KNOB<UINT64> KnobIndexInterval(KNOB_MODE_WRITEONCE, "pintool", "index", "0", "write a sidecar index for seeking with a checkpoint every N instructions (default = 0, no index)");
 KNOB<UINT64> KnobFlowControl(KNOB_MODE_WRITEONCE, "pintool", "flow", "1000", "number of instructions to send before syncing up");
 KNOB<UINT64> KnobFlowControlFF(KNOB_MODE_WRITEONCE, "pintool", "flowff", "100000", "number of instructions to batch up before sending instruction counts in fast-forward mode");
 KNOB<INT64> KnobSiftAppId(KNOB_MODE_WRITEONCE, "pintool", "s", "0", "sift app id (default = 0)");
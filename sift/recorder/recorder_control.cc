@@ -366,7 +366,11 @@ void openFile(THREADID threadid)
       #else
          const bool arch32 = false;
       #endif
-      thread_data[threadid].output = new Sift::Writer(filename, getCode, KnobUseResponseFiles.Value() ? false : true, response_filename, threadid, arch32, false, KnobSendPhysicalAddresses.Value());
+      // Framed compression is done inline (no compression threads): Pin does not support threads created through pthread_create
+      thread_data[threadid].output = new Sift::Writer(filename, getCode, KnobUseResponseFiles.Value() ? false : true, response_filename, threadid, arch32, false, KnobSendPhysicalAddresses.Value(), KnobCompressionFramed.Value(), KnobCompressionLevel.Value(), 0);
+      // A sidecar index is only useful for trace files, not when talking to Sniper directly
+      if (KnobIndexInterval.Value() && !KnobUseResponseFiles.Value())
+         thread_data[threadid].output->EnableIndex((std::string(filename) + ".idx").c_str(), KnobIndexInterval.Value());
    } catch (...) {
       std::cerr << "[SIFT_RECORDER:" << app_id << ":" << thread_data[threadid].thread_num << "] Error: Unable to open the output file " << filename << std::endl;
       exit(1);
@@ -35,8 +35,76 @@ namespace Sift
       ArchIA32 = 2,
       IcacheVariable = 4,
       PhysicalAddress = 8,
+      CompressionFramed = 16,
    } Option;
 
+   // Framed compression (CompressionFramed): the stream following the header is a sequence of independently
+   // compressed blocks, each preceded by a FrameHeader. A FrameHeader with uncompressed_size == 0 ends the stream,
+   // it is followed by the block index (one FrameIndexEntry per block) and a FrameIndexTrailer, so the index can be
+   // found by reading from the end of the file. Offsets are relative to the end of the Header.
+
+   typedef enum
+   {
+      CodecStored = 0,
+      CodecZlib = 1,
+   } Codec;
+
+   typedef struct
+   {
+      uint32_t compressed_size;
+      uint32_t uncompressed_size;
+      uint8_t codec;
+   } __attribute__ ((__packed__)) FrameHeader;
+
+   typedef struct
+   {
+      uint64_t offset;              //< Offset of the block's FrameHeader
+      uint64_t uncompressed_offset; //< Offset of the block's first byte in the uncompressed stream
+   } __attribute__ ((__packed__)) FrameIndexEntry;
+
+   typedef struct
+   {
+      uint64_t num_blocks;
+      uint32_t magic;
+   } __attribute__ ((__packed__)) FrameIndexTrailer;
+
+   const uint32_t FrameIndexMagic = 0x58464953; // "SIFX"
+
+   // Sidecar index (<trace>.idx), written by Writer::EnableIndex and used by Reader::Seek.
+   // An IndexHeader, followed by IndexEntry records in trace order. Offsets are into the uncompressed stream
+   // following the trace Header.
+   // - IndexCheckpoint: an instruction record starts at offset, with the reader state needed to start decoding there.
+   // - IndexState: a record updating reader state (icache, va2pa mapping) at offset, a copy of which (Record::Other
+   //   header and payload) follows the entry in the index, so it can be applied without reading the trace.
+   // - IndexEvent: a record with side effects (syscall, magic instruction, thread creation, ...) at offset,
+   //   the reader cannot skip past it.
+
+   const uint32_t IndexMagic = 0x49464953; // "SIFI"
+
+   typedef struct
+   {
+      uint32_t magic;
+      uint32_t reserved;
+      uint64_t interval;            //< Instructions between checkpoints
+   } __attribute__ ((__packed__)) IndexHeader;
+
+   typedef enum
+   {
+      IndexCheckpoint,
+      IndexState,
+      IndexEvent,
+   } IndexEntryType;
+
+   typedef struct
+   {
+      uint8_t type;
+      uint32_t size;                //< Size of the copied record following this entry (IndexState), else 0
+      uint64_t icount;              //< Instruction records before offset
+      uint64_t offset;
+      uint64_t last_address;        //< IndexCheckpoint: address the previous instruction ended at
+      uint64_t block;               //< IndexCheckpoint: framed compression block containing offset
+   } __attribute__ ((__packed__)) IndexEntry;
+
    typedef union
    {
       // Simple format for common instructions
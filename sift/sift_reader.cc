@@ -7,6 +7,7 @@
 #include <fstream>
 #include <cassert>
 #include <cstring>
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -18,7 +19,7 @@
 
 bool Sift::Reader::xed_initialized = false;
 
-Sift::Reader::Reader(const char *filename, const char *response_filename, uint32_t id)
+Sift::Reader::Reader(const char *filename, const char *response_filename, uint32_t id, uint32_t prefetchBlocks)
    : input(NULL)
    , response(NULL)
    , handleInstructionCountFunc(NULL)
@@ -43,6 +44,14 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
    , handleRoutineAnnounceFunc(NULL)
    , handleRoutineArg(NULL)
    , filesize(0)
+   , inputstream(NULL)
+   , m_framed_input(NULL)
+   , m_prefetch_blocks(prefetchBlocks)
+   , m_mapped_input(NULL)
+   , m_in_place(false)
+   , m_icount(0)
+   , m_have_pending(false)
+   , m_index_loaded(false)
    , last_address(0)
    , icache()
    , m_id(id)
@@ -59,6 +68,8 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
       xed_initialized = true;
    }
 
+   memset(m_scache_direct, 0, sizeof(m_scache_direct));
+
    m_filename = strdup(filename);
    m_response_filename = strdup(response_filename);
 
@@ -70,15 +81,17 @@ Sift::Reader::~Reader()
 {
    free(m_filename);
    free(m_response_filename);
+   for(FlatHashMap<uint64_t, const uint8_t*>::iterator i = icache.begin() ; i != icache.end() ; ++i)
+   {
+      // Pages parsed in place live in the mapped trace file
+      if (!(m_mapped_input && m_mapped_input->contains((*i).second)))
+         delete [] (*i).second;
+   }
    if (input)
       delete input;
    if (response)
       delete response;
-   for(std::unordered_map<uint64_t, const uint8_t*>::iterator i = icache.begin() ; i != icache.end() ; ++i)
-   {
-      delete [] (*i).second;
-   }
-   for(std::unordered_map<uint64_t, const StaticInstruction*>::iterator i = scache.begin() ; i != scache.end() ; ++i)
+   for(FlatHashMap<uint64_t, const StaticInstruction*>::iterator i = scache.begin() ; i != scache.end() ; ++i)
    {
       delete (*i).second;
    }
@@ -90,20 +103,29 @@ void Sift::Reader::initStream()
    std::cerr << "[DEBUG:" << m_id << "] InitStream Attempting Open" << std::endl;
    #endif
 
-   inputstream = new std::ifstream(m_filename, std::ios::in);
-
-   if (!inputstream->is_open())
+   // Trace files are memory mapped, pipes (and files that cannot be mapped) are read through an ifstream
+   m_mapped_input = vimstream::open(m_filename);
+   if (m_mapped_input)
    {
-      std::cerr << "Cannot open " << m_filename << std::endl;
-      assert(false);
+      input = m_mapped_input;
+   }
+   else
+   {
+      inputstream = new std::ifstream(m_filename, std::ios::in);
+
+      if (!inputstream->is_open())
+      {
+         std::cerr << "Cannot open " << m_filename << std::endl;
+         assert(false);
+      }
+
+      input = new vifstream(inputstream);
    }
 
    struct stat filestatus;
    stat(m_filename, &filestatus);
    filesize = filestatus.st_size;
 
-   input = new vifstream(inputstream);
-
    Sift::Header hdr;
    input->read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
    assert(hdr.magic == Sift::MagicNumber);
@@ -114,6 +136,12 @@ void Sift::Reader::initStream()
       input = new izstream(input);
       hdr.options &= ~CompressionZlib;
    }
+   else if (hdr.options & CompressionFramed)
+   {
+      m_framed_input = new iframestream(input, sizeof(hdr), m_prefetch_blocks);
+      input = m_framed_input;
+      hdr.options &= ~CompressionFramed;
+   }
 
    if (hdr.options & ArchIA32)
    {
@@ -138,6 +166,8 @@ void Sift::Reader::initStream()
    // Make sure there are no unrecognized options
    assert(hdr.options == 0);
 
+   m_in_place = m_mapped_input && input == m_mapped_input;
+
    #if VERBOSE > 0
    std::cerr << "[DEBUG:" << m_id << "] InitStream Connection Open" << std::endl;
    #endif
@@ -158,7 +188,39 @@ void Sift::Reader::initResponse()
    }
 }
 
+inline void Sift::Reader::readRecord(const Record* &prec, Record &rec, size_t size)
+{
+   prec = m_in_place ? reinterpret_cast<const Record*>(m_mapped_input->consume(size)) : NULL;
+   if (!prec)
+   {
+      input->read(reinterpret_cast<char*>(&rec), size);
+      prec = &rec;
+   }
+}
+
 bool Sift::Reader::Read(Instruction &inst)
+{
+   return readInstruction(inst, false);
+}
+
+size_t Sift::Reader::ReadBatch(Instruction *insts, size_t count)
+{
+   // Records with side effects (syscalls, magic instructions, ...) are only handled before the first instruction
+   // of a batch. The caller therefore sees them at the same point in the instruction stream as with Read().
+   size_t num = 0;
+   while(num < count && readInstruction(insts[num], num > 0))
+      ++num;
+   return num;
+}
+
+inline bool Sift::Reader::canReadAhead(uint8_t type)
+{
+   // Icache contents are only used to decode the instructions that follow them. Address mappings are not
+   // included: va2pa() can be called for earlier instructions, and should not see mappings that came later.
+   return type == RecOtherIcache || type == RecOtherIcacheVariable;
+}
+
+bool Sift::Reader::readInstruction(Instruction &inst, bool stop_at_event)
 {
    if (input == NULL)
    {
@@ -168,13 +230,36 @@ bool Sift::Reader::Read(Instruction &inst)
    while(!m_seen_end)
    {
       Record rec;
-      uint8_t byte = input->peek();
-      assert(!input->fail());
+      uint8_t byte = 0;
+      const Record *prec = &rec;
+
+      if (m_have_pending)
+      {
+         // Record header that was read by a previous call, which stopped there
+         rec.Other.zero = 0;
+         rec.Other.type = m_pending_type;
+         rec.Other.size = m_pending_size;
+         m_have_pending = false;
+      }
+      else
+      {
+         byte = input->peek();
+         assert(!input->fail());
+         if (byte == 0)
+            input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+      }
 
       if (byte == 0)
       {
          // Other
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+         if (stop_at_event && !canReadAhead(rec.Other.type))
+         {
+            m_pending_type = rec.Other.type;
+            m_pending_size = rec.Other.size;
+            m_have_pending = true;
+            return false;
+         }
+
          switch(rec.Other.type)
          {
             case RecOtherEnd:
@@ -184,53 +269,10 @@ bool Sift::Reader::Read(Instruction &inst)
                //sendSimpleResponse(RecOtherEndResponse);
                return false;
             case RecOtherIcache:
-            {
-               assert(rec.Other.size == sizeof(uint64_t) + ICACHE_SIZE);
-               uint64_t address;
-               uint8_t *bytes = new uint8_t[ICACHE_SIZE];
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(bytes), ICACHE_SIZE);
-               icache[address] = bytes;
-               break;
-            }
             case RecOtherIcacheVariable:
-            {
-               #if VERBOSE_ICACHE
-               std::cerr << __FUNCTION__ << ": rec=" << std::endl;
-               hexdump(&rec, sizeof(rec.Other));
-               #endif
-               uint64_t address;
-               size_t size = rec.Other.size - sizeof(uint64_t);
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
-               size_t size_left = size;
-               while (size_left > 0)
-               {
-                  uint64_t base_addr = address & ICACHE_PAGE_MASK;
-                  if (icache.count(base_addr) == 0)
-                     icache[base_addr] = new uint8_t[ICACHE_SIZE];
-                  uint64_t offset = address & ICACHE_OFFSET_MASK;
-                  size_t read_amount = std::min(size_left, size_t(ICACHE_SIZE - offset));
-                  input->read(const_cast<char*>(reinterpret_cast<const char*>(&(icache[base_addr][offset]))), read_amount);
-
-                  #if VERBOSE_ICACHE
-                  std::cerr << __FUNCTION__ << ": Wrote " << read_amount << " bytes to 0x" << std::hex << (void*)&(icache[base_addr][offset]) << std::dec << std::endl;
-                  hexdump(&(icache[base_addr][offset]), read_amount);
-                  #endif
-
-                  size_left -= read_amount;
-                  address = base_addr + ICACHE_SIZE;
-               }
-               break;
-            }
             case RecOtherLogical2Physical:
-            {
-               assert(rec.Other.size == 2 * sizeof(uint64_t));
-               uint64_t vp, pp;
-               input->read(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
-               vcache[vp] = pp;
+               handleStateRecord(rec, input);
                break;
-            }
             case RecOtherInstructionCount:
             {
                #if VERBOSE > 0
@@ -462,46 +504,53 @@ bool Sift::Reader::Read(Instruction &inst)
       if ((byte & 0xf) != 0)
       {
          // Instruction
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Instruction));
+         readRecord(prec, rec, sizeof(rec.Instruction));
 
          #if VERBOSE_HEX > 2
-         hexdump(&rec, sizeof(rec.Instruction));
+         hexdump(prec, sizeof(rec.Instruction));
          #endif
 
-         size = rec.Instruction.size;
+         size = prec->Instruction.size;
          addr = last_address;
-         inst.num_addresses = rec.Instruction.num_addresses;
-         inst.is_branch = rec.Instruction.is_branch;
-         inst.taken = rec.Instruction.taken;
+         inst.num_addresses = prec->Instruction.num_addresses;
+         inst.is_branch = prec->Instruction.is_branch;
+         inst.taken = prec->Instruction.taken;
          inst.is_predicate = false;
          inst.executed = true;
       }
       else
       {
          // InstructionExt
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.InstructionExt));
+         readRecord(prec, rec, sizeof(rec.InstructionExt));
 
          #if VERBOSE_HEX > 2
-         hexdump(&rec, sizeof(rec.InstructionExt));
+         hexdump(prec, sizeof(rec.InstructionExt));
          #endif
 
-         size = rec.InstructionExt.size;
-         addr = rec.InstructionExt.addr;
-         inst.num_addresses = rec.InstructionExt.num_addresses;
-         inst.is_branch = rec.InstructionExt.is_branch;
-         inst.taken = rec.InstructionExt.taken;
-         inst.is_predicate = rec.InstructionExt.is_predicate;
-         inst.executed = rec.InstructionExt.executed;
+         size = prec->InstructionExt.size;
+         addr = prec->InstructionExt.addr;
+         inst.num_addresses = prec->InstructionExt.num_addresses;
+         inst.is_branch = prec->InstructionExt.is_branch;
+         inst.taken = prec->InstructionExt.taken;
+         inst.is_predicate = prec->InstructionExt.is_predicate;
+         inst.executed = prec->InstructionExt.executed;
 
          last_address = addr;
       }
 
       last_address += size;
 
-      for(int i = 0; i < inst.num_addresses; ++i)
-         input->read(reinterpret_cast<char*>(&inst.addresses[i]), sizeof(uint64_t));
+      if (inst.num_addresses)
+      {
+         const char *addresses = m_in_place ? m_mapped_input->consume(inst.num_addresses * sizeof(uint64_t)) : NULL;
+         if (addresses)
+            memcpy(inst.addresses, addresses, inst.num_addresses * sizeof(uint64_t));
+         else
+            input->read(reinterpret_cast<char*>(inst.addresses), inst.num_addresses * sizeof(uint64_t));
+      }
 
       inst.sinst = getStaticInstruction(addr, size);
+      ++m_icount;
 
       #if VERBOSE_HEX > 2
       hexdump(inst.sinst->data, inst.sinst->size);
@@ -513,11 +562,227 @@ bool Sift::Reader::Read(Instruction &inst)
       return true;
    }
 
-   // We should not return false (no more instructions) unless we get the End packet.
-   // Return true in case we get to this point (which we shouldn't).
+   // Only reached when the End packet was seen by an earlier call
+   return false;
+}
+
+// Records that update reader state (icache contents, va2pa mappings), read from in
+// (the trace, or a copy of the record stored in the sidecar index)
+void Sift::Reader::handleStateRecord(const Record &rec, vistream *in)
+{
+   switch(rec.Other.type)
+   {
+      case RecOtherIcache:
+      {
+         assert(rec.Other.size == sizeof(uint64_t) + ICACHE_SIZE);
+         uint64_t address;
+         in->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+         const uint8_t *bytes = (in == input && m_in_place) ? reinterpret_cast<const uint8_t*>(m_mapped_input->consume(ICACHE_SIZE)) : NULL;
+         if (!bytes)
+         {
+            uint8_t *buffer = new uint8_t[ICACHE_SIZE];
+            in->read(reinterpret_cast<char*>(buffer), ICACHE_SIZE);
+            bytes = buffer;
+         }
+         icache[address] = bytes;
+         break;
+      }
+      case RecOtherIcacheVariable:
+      {
+         #if VERBOSE_ICACHE
+         std::cerr << __FUNCTION__ << ": rec=" << std::endl;
+         hexdump(&rec, sizeof(rec.Other));
+         #endif
+         uint64_t address;
+         size_t size = rec.Other.size - sizeof(uint64_t);
+         in->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+         size_t size_left = size;
+         while (size_left > 0)
+         {
+            uint64_t base_addr = address & ICACHE_PAGE_MASK;
+            const uint8_t* &page = icache[base_addr];
+            if (page == NULL)
+               page = new uint8_t[ICACHE_SIZE];
+            else if (m_mapped_input && m_mapped_input->contains(page))
+            {
+               // Page lives in the (read-only) mapped trace file, take a private copy before updating it
+               uint8_t *bytes = new uint8_t[ICACHE_SIZE];
+               memcpy(bytes, page, ICACHE_SIZE);
+               page = bytes;
+            }
+            uint64_t offset = address & ICACHE_OFFSET_MASK;
+            size_t read_amount = std::min(size_left, size_t(ICACHE_SIZE - offset));
+            in->read(const_cast<char*>(reinterpret_cast<const char*>(&(page[offset]))), read_amount);
+
+            #if VERBOSE_ICACHE
+            std::cerr << __FUNCTION__ << ": Wrote " << read_amount << " bytes to 0x" << std::hex << (void*)&(page[offset]) << std::dec << std::endl;
+            hexdump(&(page[offset]), read_amount);
+            #endif
+
+            size_left -= read_amount;
+            address = base_addr + ICACHE_SIZE;
+         }
+         break;
+      }
+      case RecOtherLogical2Physical:
+      {
+         assert(rec.Other.size == 2 * sizeof(uint64_t));
+         uint64_t vp, pp;
+         in->read(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
+         vcache[vp] = pp;
+         break;
+      }
+      default:
+         assert(false);
+   }
+}
+
+bool Sift::Reader::loadIndex()
+{
+   if (m_index_loaded)
+      return m_index.size() > 0;
+   m_index_loaded = true;
+
+   // Seeking requires random access into the uncompressed trace
+   if (!m_in_place && !(m_framed_input && m_mapped_input))
+      return false;
+
+   std::string index_filename = std::string(m_filename) + ".idx";
+   std::ifstream index(index_filename.c_str(), std::ios::in | std::ios::binary);
+   if (!index.is_open())
+      return false;
+   m_index_data.assign(std::istreambuf_iterator<char>(index), std::istreambuf_iterator<char>());
+
+   IndexHeader hdr;
+   if (m_index_data.size() < sizeof(hdr))
+      return false;
+   memcpy(&hdr, &m_index_data[0], sizeof(hdr));
+   if (hdr.magic != IndexMagic)
+   {
+      std::cerr << "Invalid SIFT index " << index_filename << ", ignoring" << std::endl;
+      return false;
+   }
+
+   for(size_t pos = sizeof(hdr); pos + sizeof(IndexEntry) <= m_index_data.size(); )
+   {
+      IndexPoint point;
+      memcpy(&point.entry, &m_index_data[pos], sizeof(IndexEntry));
+      pos += sizeof(IndexEntry);
+      point.record = &m_index_data[pos];
+      pos += point.entry.size;
+      // Ignore a truncated last entry
+      if (pos > m_index_data.size())
+         break;
+      if (point.entry.type == IndexCheckpoint)
+         m_index_checkpoints.push_back(m_index.size());
+      else if (point.entry.type == IndexEvent)
+         m_index_events.push_back(m_index.size());
+      m_index.push_back(point);
+   }
+
+   if (m_framed_input)
+   {
+      // The frame index is at the end of the trace file
+      FrameIndexTrailer trailer;
+      std::ifstream trace(m_filename, std::ios::in | std::ios::binary);
+      trace.seekg(-int64_t(sizeof(trailer)), std::ios::end);
+      trace.read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+      if (trace.fail() || trailer.magic != FrameIndexMagic)
+      {
+         m_index.clear();
+         m_index_checkpoints.clear();
+         m_index_events.clear();
+         return false;
+      }
+      m_frames.resize(trailer.num_blocks);
+      trace.seekg(-int64_t(sizeof(trailer) + trailer.num_blocks * sizeof(FrameIndexEntry)), std::ios::end);
+      if (trailer.num_blocks)
+         trace.read(reinterpret_cast<char*>(&m_frames[0]), trailer.num_blocks * sizeof(FrameIndexEntry));
+      if (trace.fail())
+      {
+         m_index.clear();
+         m_index_checkpoints.clear();
+         m_index_events.clear();
+         return false;
+      }
+   }
+
+   return m_index.size() > 0;
+}
+
+bool Sift::Reader::getStreamOffset(uint64_t &offset)
+{
+   if (m_in_place)
+      offset = m_mapped_input->tell() - sizeof(Header);
+   else if (m_framed_input)
+      offset = m_framed_input->tell();
+   else
+      return false;
    return true;
 }
 
+uint64_t Sift::Reader::Seek(uint64_t icount)
+{
+   if (input == NULL)
+   {
+      initStream();
+   }
+
+   uint64_t offset;
+   if (icount <= m_icount || m_seen_end || m_have_pending || !loadIndex() || !getStreamOffset(offset))
+      return m_icount;
+
+   // Find the last checkpoint at or before icount that can be reached without skipping past an event
+   size_t first = std::lower_bound(m_index.begin(), m_index.end(), offset, IndexPoint::OffsetLess()) - m_index.begin();
+   std::vector<size_t>::iterator event = std::lower_bound(m_index_events.begin(), m_index_events.end(), first);
+   size_t limit = event == m_index_events.end() ? m_index.size() : *event;
+
+   std::vector<size_t>::iterator checkpoints_end = std::lower_bound(m_index_checkpoints.begin(), m_index_checkpoints.end(), limit);
+   std::vector<size_t>::iterator next_checkpoint = std::upper_bound(m_index_checkpoints.begin(), checkpoints_end, icount, IndexPoint::CheckpointLess(m_index));
+   if (next_checkpoint == m_index_checkpoints.begin())
+      return m_icount;
+   size_t target = *(next_checkpoint - 1);
+   if (target < first || m_index[target].entry.icount <= m_icount)
+      return m_icount;
+
+   const IndexEntry &checkpoint = m_index[target].entry;
+
+   // Reposition the trace
+   if (m_in_place)
+   {
+      if (!m_mapped_input->seek(sizeof(Header) + checkpoint.offset))
+         return m_icount;
+   }
+   else
+   {
+      if (checkpoint.block >= m_frames.size()
+         || !m_framed_input->seekBlock(m_frames[checkpoint.block].offset, m_frames[checkpoint.block].uncompressed_offset, checkpoint.offset - m_frames[checkpoint.block].uncompressed_offset))
+      {
+         std::cerr << "Cannot seek in SIFT trace " << m_filename << std::endl;
+         assert(false);
+      }
+   }
+
+   // Apply the state records that were skipped over
+   for(size_t i = first; i < target; ++i)
+   {
+      if (m_index[i].entry.type == IndexState)
+      {
+         Record rec;
+         memcpy(&rec, m_index[i].record, sizeof(rec.Other));
+         vimstream record(m_index[i].record + sizeof(rec.Other), m_index[i].entry.size - sizeof(rec.Other));
+         handleStateRecord(rec, &record);
+      }
+   }
+
+   last_address = checkpoint.last_address;
+   m_icount = checkpoint.icount;
+   m_last_sinst = NULL;
+
+   return m_icount;
+}
+
 void Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op, uint64_t d_addr, uint8_t *data_buffer, uint32_t data_size)
 {
    #if VERBOSE > 0
@@ -608,8 +873,9 @@ const Sift::StaticInstruction* Sift::Reader::decodeInstruction(uint64_t addr, ui
    {
       uint32_t offset = (dst == sinst->data) ? addr & ICACHE_OFFSET_MASK : 0;
       uint32_t _size = std::min(uint32_t(size), ICACHE_SIZE - offset);
-      assert(icache.count(base_addr));
-      memcpy(dst, icache[base_addr] + offset, _size);
+      const uint8_t **page = icache.find(base_addr);
+      assert(page);
+      memcpy(dst, *page + offset, _size);
       dst += _size;
       size -= _size;
       base_addr += ICACHE_SIZE;
@@ -627,21 +893,31 @@ const Sift::StaticInstruction* Sift::Reader::getStaticInstruction(uint64_t addr,
 {
    const StaticInstruction *sinst;
 
-   // Lookup in a large unordered_map is quite expensive if we have to do this for every dynamic instruction
+   // Lookup in a large hash map is quite expensive if we have to do this for every dynamic instruction
    // Therefore, keep a pointer to the probable next instruction in each (static) instruction
+   // Next, try a small direct-mapped cache before falling back to the hash map
+   const StaticInstruction* &slot = m_scache_direct[(addr ^ (addr >> SCACHE_DIRECT_BITS)) & ((1 << SCACHE_DIRECT_BITS) - 1)];
    if (m_last_sinst && m_last_sinst->next && m_last_sinst->next->addr == addr)
    {
       sinst = m_last_sinst->next;
    }
-   else if (scache.count(addr))
+   else if (slot && slot->addr == addr)
    {
-      sinst = scache[addr];
-      assert(sinst->size == size);
+      sinst = slot;
    }
    else
    {
-      sinst = decodeInstruction(addr, size);
-      scache[addr] = sinst;
+      const StaticInstruction* &entry = scache[addr];
+      if (entry)
+      {
+         assert(entry->size == size);
+      }
+      else
+      {
+         entry = decodeInstruction(addr, size);
+      }
+      sinst = entry;
+      slot = sinst;
    }
 
    if (m_last_sinst && m_last_sinst->next == NULL)
@@ -711,7 +987,12 @@ void Sift::Reader::sendSimpleResponse(RecOtherType type, void *data, uint32_t si
 
 uint64_t Sift::Reader::getPosition()
 {
-   if (inputstream)
+   // Blocks are read ahead by a background thread, report what was consumed so far
+   if (m_framed_input)
+      return sizeof(Sift::Header) + m_framed_input->getPosition();
+   else if (m_mapped_input)
+      return m_mapped_input->tell();
+   else if (inputstream)
       return inputstream->tellg();
    else
       return 0;
@@ -729,14 +1010,14 @@ uint64_t Sift::Reader::va2pa(uint64_t va)
       intptr_t vp = va / PAGE_SIZE;
       intptr_t vo = va & (PAGE_SIZE-1);
 
-      if (vcache.count(vp) == 0)
+      uint64_t *pp = vcache.find(vp);
+      if (pp == NULL)
       {
          return 0;
       }
       else
       {
-         intptr_t pp = vcache[vp];
-         return (pp * PAGE_SIZE) | vo;
+         return (*pp * PAGE_SIZE) | vo;
       }
    }
    else
@@ -8,12 +8,16 @@ extern "C" {
 #include "xed-interface.h"
 }
 
-#include <unordered_map>
+#include "flat_hash_map.h"
+
+#include <vector>
 #include <fstream>
 #include <cassert>
 
 class vistream;
 class vostream;
+class iframestream;
+class vimstream;
 
 namespace Sift
 {
@@ -83,6 +87,42 @@ namespace Sift
          void *handleRoutineArg;
          uint64_t filesize;
          std::ifstream *inputstream;
+         iframestream *m_framed_input;
+         const uint32_t m_prefetch_blocks;   // Number of blocks of a framed trace decompressed ahead of the reader
+         vimstream *m_mapped_input;          // Memory-mapped trace file, if any
+         bool m_in_place;                    // Records can be parsed in place in m_mapped_input (uncompressed trace)
+
+         uint64_t m_icount;                  // Instruction records read so far
+         bool m_have_pending;                // ReadBatch stopped after reading the header of an Other record
+         uint8_t m_pending_type;
+         uint32_t m_pending_size;
+
+         // Sidecar index (see Sift::IndexEntry), loaded on the first Seek()
+         struct IndexPoint
+         {
+            IndexEntry entry;
+            const char *record;              // Copy of the state record for IndexState entries
+
+            // For binary searches on m_index, and on m_index_checkpoints by the icount of the checkpoints
+            struct OffsetLess
+            {
+               bool operator()(const IndexPoint &point, uint64_t offset) const { return point.entry.offset < offset; }
+            };
+            struct CheckpointLess
+            {
+               const std::vector<IndexPoint> &index;
+               CheckpointLess(const std::vector<IndexPoint> &_index) : index(_index) {}
+               bool operator()(uint64_t icount, size_t pos) const { return icount < index[pos].entry.icount; }
+            };
+         };
+         bool m_index_loaded;
+         std::vector<char> m_index_data;
+         std::vector<IndexPoint> m_index;
+         // Positions in m_index of the checkpoints and events. m_index is in trace order, so it is sorted by
+         // both offset and icount, and so are these.
+         std::vector<size_t> m_index_checkpoints;
+         std::vector<size_t> m_index_events;
+         std::vector<FrameIndexEntry> m_frames;
 
          char *m_filename;
          char *m_response_filename;
@@ -91,9 +131,11 @@ namespace Sift
          xed_state_t m_xed_state_init;
 
          uint64_t last_address;
-         std::unordered_map<uint64_t, const uint8_t*> icache;
-         std::unordered_map<uint64_t, const StaticInstruction*> scache;
-         std::unordered_map<uint64_t, uint64_t> vcache;
+         FlatHashMap<uint64_t, const uint8_t*> icache;
+         FlatHashMap<uint64_t, const StaticInstruction*> scache;
+         static const uint32_t SCACHE_DIRECT_BITS = 12;
+         const StaticInstruction* m_scache_direct[1 << SCACHE_DIRECT_BITS];  // Direct-mapped cache in front of scache
+         FlatHashMap<uint64_t, uint64_t> vcache;
 
          uint32_t m_id;
 
@@ -104,15 +146,33 @@ namespace Sift
          void initResponse();
          const Sift::StaticInstruction* decodeInstruction(uint64_t addr, uint8_t size);
          const Sift::StaticInstruction* getStaticInstruction(uint64_t addr, uint8_t size);
+         bool readInstruction(Instruction &inst, bool stop_at_event);
+         static bool canReadAhead(uint8_t type);
+         void handleStateRecord(const Record &rec, vistream *in);
+         bool loadIndex();
+         bool getStreamOffset(uint64_t &offset);
+         // Point prec to the next size bytes of the trace, in the mapped trace file if possible, else read into rec
+         void readRecord(const Record* &prec, Record &rec, size_t size);
          void sendSyscallResponse(uint64_t return_code);
          void sendEmuResponse(bool handled, EmuReply res);
          void sendSimpleResponse(RecOtherType type, void *data = NULL, uint32_t size = 0);
 
       public:
-         Reader(const char *filename, const char *response_filename = "", uint32_t id = 0);
+         // For framed traces, prefetchBlocks blocks are decompressed ahead on a background thread (0: decompress on demand)
+         Reader(const char *filename, const char *response_filename = "", uint32_t id = 0, uint32_t prefetchBlocks = 4);
          ~Reader();
          void initStream();
          bool Read(Instruction&);
+         // Read up to count instructions, returns the number read, which is zero only at the end of the trace.
+         // Stops early before a record with side effects (anything but icache records), which is handled at the
+         // start of the next call.
+         size_t ReadBatch(Instruction *insts, size_t count);
+         // Skip ahead towards instruction icount (counted from the start of the trace) using the sidecar index
+         // <trace>.idx, without decoding the records in between. Never skips past records with side effects
+         // (syscalls, magic instructions, ...), and does nothing if there is no index or the trace cannot be
+         // repositioned (zlib-compressed or a pipe). Returns the number of the instruction the next Read() returns.
+         uint64_t Seek(uint64_t icount);
+         uint64_t getInstructionCount() const { return m_icount; }
          void AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op, uint64_t d_addr, uint8_t *data_buffer, uint32_t data_size);
 
          void setHandleInstructionCountFunc(HandleInstructionCountFunc func, void* arg = NULL) { handleInstructionCountFunc = func; handleInstructionCountArg = arg; }
@@ -129,6 +189,8 @@ namespace Sift
          uint64_t getPosition();
          uint64_t getLength();
          bool getTraceHasPhysicalAddresses() const { return m_trace_has_pa; }
+         // Mode in which the trace's code is decoded (32 or 64-bit), known once the stream has been initialized
+         xed_machine_mode_enum_t getMachineMode() const { return m_xed_state_init.mmode; }
          uint64_t va2pa(uint64_t va);
    };
 };
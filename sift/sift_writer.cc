@@ -30,7 +30,7 @@ __sift_assert_fail(__const char *__assertion, __const char *__file,
 }
 
 
-Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping)
+Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, bool useFramedCompression, int compressionLevel, uint32_t compressionThreads)
    : response(NULL)
    , getCodeFunc(getCodeFunc)
    , ninstrs(0)
@@ -45,6 +45,11 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
    , m_id(id)
    , m_requires_icache_per_insn(requires_icache_per_insn)
    , m_send_va2pa_mapping(send_va2pa_mapping)
+   , m_blocksize(0)
+   , m_position(NULL)
+   , m_index(NULL)
+   , m_index_interval(0)
+   , m_index_next(0)
 {
    memset(hsize, 0, sizeof(hsize));
    memset(haddr, 0, sizeof(haddr));
@@ -53,7 +58,7 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
 
    uint64_t options = 0;
    if (useCompression)
-      options |= CompressionZlib;
+      options |= useFramedCompression ? CompressionFramed : CompressionZlib;
    if (arch32)
       options |= ArchIA32;
    if (requires_icache_per_insn)
@@ -73,6 +78,44 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
 
    if (options & CompressionZlib)
       output = new ozstream(output);
+   else if (options & CompressionFramed)
+   {
+      oframestream *framed = new oframestream(output, BlockCodec::create(CodecZlib, compressionLevel), compressionThreads);
+      m_blocksize = framed->getBlockSize();
+      output = framed;
+   }
+}
+
+void Sift::Writer::EnableIndex(const char *index_filename, uint64_t interval)
+{
+   sift_assert(ninstrs == 0 && m_index == NULL);
+   sift_assert(interval > 0);
+
+   // Count the bytes going into the (uncompressed) trace
+   m_position = new vocountstream(output);
+   output = m_position;
+
+   m_index = new vofstream(index_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+   sift_assert(m_index->is_open());
+   m_index_interval = interval;
+   m_index_next = 0;
+
+   IndexHeader hdr = { IndexMagic, 0, interval };
+   m_index->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+}
+
+void Sift::Writer::writeIndex(IndexEntryType type, const Record *rec, const void *payload1, uint32_t size1, const void *payload2, uint32_t size2)
+{
+   uint64_t offset = m_position->getCount();
+   IndexEntry entry = { uint8_t(type), rec ? uint32_t(sizeof(rec->Other) + size1 + size2) : 0, ninstrs, offset, last_address, m_blocksize ? offset / m_blocksize : 0 };
+   m_index->write(reinterpret_cast<char*>(&entry), sizeof(entry));
+   if (rec)
+   {
+      m_index->write(reinterpret_cast<const char*>(rec), sizeof(rec->Other));
+      m_index->write(reinterpret_cast<const char*>(payload1), size1);
+      if (size2)
+         m_index->write(reinterpret_cast<const char*>(payload2), size2);
+   }
 }
 
 // Modified from http://stackoverflow.com/questions/2203159/is-there-a-c-equivalent-to-getcwd
@@ -130,6 +173,12 @@ void Sift::Writer::End()
       delete output;
       output = NULL;
    }
+
+   if (m_index)
+   {
+      delete m_index;
+      m_index = NULL;
+   }
 }
 
 Sift::Writer::~Writer()
@@ -155,6 +204,12 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
    sift_assert(size < 16);
    sift_assert(num_addresses <= MAX_DYNAMIC_ADDRESSES);
 
+   if (m_index && ninstrs >= m_index_next)
+   {
+      writeIndex(IndexCheckpoint);
+      m_index_next = ninstrs + m_index_interval;
+   }
+
    if (m_requires_icache_per_insn)
    {
       if (! icache[addr])
@@ -166,11 +221,15 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
          rec.Other.zero = 0;
          rec.Other.type = RecOtherIcacheVariable;
          rec.Other.size = sizeof(uint64_t) + size;
-         output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
-         output->write(reinterpret_cast<char*>(&addr), sizeof(uint64_t));
 
          uint8_t buffer[16] = {0};
          getCodeFunc(buffer, reinterpret_cast<const uint8_t *>(addr), size);
+
+         if (m_index)
+            writeIndex(IndexState, &rec, &addr, sizeof(uint64_t), buffer, size);
+
+         output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+         output->write(reinterpret_cast<char*>(&addr), sizeof(uint64_t));
          output->write(reinterpret_cast<char*>(buffer), size);
 
          #if VERBOSE_ICACHE
@@ -194,11 +253,15 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
             rec.Other.zero = 0;
             rec.Other.type = RecOtherIcache;
             rec.Other.size = sizeof(uint64_t) + ICACHE_SIZE;
-            output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
-            output->write(reinterpret_cast<char*>(&base_addr), sizeof(uint64_t));
 
             uint8_t buffer[ICACHE_SIZE];
             getCodeFunc(buffer, (const uint8_t *)base_addr, ICACHE_SIZE);
+
+            if (m_index)
+               writeIndex(IndexState, &rec, &base_addr, sizeof(uint64_t), buffer, ICACHE_SIZE);
+
+            output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+            output->write(reinterpret_cast<char*>(&base_addr), sizeof(uint64_t));
             output->write(reinterpret_cast<char*>(buffer), ICACHE_SIZE);
 
             icache[base_addr] = true;
@@ -278,6 +341,8 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
 
 Sift::Mode Sift::Writer::InstructionCount(uint32_t icount)
 {
+   indexEvent();
+
    #if VERBOSE > 1
    std::cerr << "[DEBUG:" << m_id << "] Write InstructionCount" << std::endl;
    #endif
@@ -311,6 +376,8 @@ Sift::Mode Sift::Writer::InstructionCount(uint32_t icount)
 
 void Sift::Writer::CacheOnly(uint8_t icount, CacheOnlyType type, uint64_t eip, uint64_t address)
 {
+   indexEvent();
+
    #if VERBOSE > 1
    std::cerr << "[DEBUG:" << m_id << "] Write CacheOnly" << std::endl;
    #endif
@@ -342,6 +409,8 @@ void Sift::Writer::CacheOnly(uint8_t icount, CacheOnlyType type, uint64_t eip, u
 
 void Sift::Writer::Output(uint8_t fd, const char *data, uint32_t size)
 {
+   indexEvent();
+
    #if VERBOSE > 1
    std::cerr << "[DEBUG:" << m_id << "] Write Output" << std::endl;
    #endif
@@ -364,6 +433,8 @@ void Sift::Writer::Output(uint8_t fd, const char *data, uint32_t size)
 
 int32_t Sift::Writer::NewThread()
 {
+   indexEvent();
+
    #if VERBOSE > 0
    std::cerr << "[DEBUG:" << m_id << "] Write NewThread" << std::endl;
    #endif
@@ -416,6 +487,8 @@ static T force_read(volatile T *addr)
 
 uint64_t Sift::Writer::Syscall(uint16_t syscall_number, const char *data, uint32_t size)
 {
+   indexEvent();
+
    #if VERBOSE > 0
    std::cerr << "[DEBUG:" << m_id << "] Write Syscall" << std::endl;
    #endif
@@ -486,6 +559,8 @@ uint64_t Sift::Writer::Syscall(uint16_t syscall_number, const char *data, uint32
 
 int32_t Sift::Writer::Join(int32_t thread)
 {
+   indexEvent();
+
    #if VERBOSE > 0
    std::cerr << "[DEBUG:" << m_id << "] Write Join with thread=" << thread << std::endl;
    #endif
@@ -533,6 +608,8 @@ int32_t Sift::Writer::Join(int32_t thread)
 
 Sift::Mode Sift::Writer::Sync()
 {
+   indexEvent();
+
    // send sync
    Record rec;
    rec.Other.zero = 0;
@@ -575,6 +652,8 @@ Sift::Mode Sift::Writer::Sync()
 
 int32_t Sift::Writer::Fork()
 {
+   indexEvent();
+
    Record rec;
    rec.Other.zero = 0;
    rec.Other.type = RecOtherFork;
@@ -600,6 +679,8 @@ int32_t Sift::Writer::Fork()
 
 uint64_t Sift::Writer::Magic(uint64_t a, uint64_t b, uint64_t c)
 {
+   indexEvent();
+
    // send magic
    Record rec;
    rec.Other.zero = 0;
@@ -645,6 +726,8 @@ uint64_t Sift::Writer::Magic(uint64_t a, uint64_t b, uint64_t c)
 
 bool Sift::Writer::Emulate(Sift::EmuType type, Sift::EmuRequest &req, Sift::EmuReply &res)
 {
+   indexEvent();
+
    // send magic
    Record rec;
    rec.Other.zero = 0;
@@ -692,6 +775,8 @@ bool Sift::Writer::Emulate(Sift::EmuType type, Sift::EmuRequest &req, Sift::EmuR
 
 void Sift::Writer::RoutineChange(Sift::RoutineOpType event, uint64_t eip, uint64_t esp, uint64_t callEip)
 {
+   indexEvent();
+
    Record rec;
    rec.Other.zero = 0;
    rec.Other.type = RecOtherRoutineChange;
@@ -706,6 +791,8 @@ void Sift::Writer::RoutineChange(Sift::RoutineOpType event, uint64_t eip, uint64
 
 void Sift::Writer::RoutineAnnounce(uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename)
 {
+   indexEvent();
+
    uint16_t len_name = strlen(name) + 1, len_imgname = strlen(imgname) + 1, len_filename = strlen(filename) + 1;
 
    Record rec;
@@ -727,6 +814,8 @@ void Sift::Writer::RoutineAnnounce(uint64_t eip, const char *name, const char *i
 
 void Sift::Writer::handleMemoryRequest(Record &respRec)
 {
+   indexEvent();
+
    #if VERBOSE > 0
    std::cerr << "[DEBUG:" << m_id << "] Read MemoryRequest" << std::endl;
    #endif
@@ -850,6 +939,13 @@ void Sift::Writer::send_va2pa(uint64_t va)
             rec.Other.zero = 0;
             rec.Other.type = RecOtherLogical2Physical;
             rec.Other.size = 2 * sizeof(uint64_t);
+
+            if (m_index)
+            {
+               uint64_t mapping[2] = { vp, pp };
+               writeIndex(IndexState, &rec, mapping, sizeof(mapping));
+            }
+
             output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
             output->write(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
             output->write(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
@@ -10,6 +10,7 @@
 
 class vistream;
 class vostream;
+class vocountstream;
 
 namespace Sift
 {
@@ -34,16 +35,28 @@ namespace Sift
          uint32_t m_id;
          bool m_requires_icache_per_insn;
          bool m_send_va2pa_mapping;
+         size_t m_blocksize;
+         vocountstream *m_position;
+         vostream *m_index;
+         uint64_t m_index_interval, m_index_next;
 
          void initResponse();
          void handleMemoryRequest(Record &respRec);
          void send_va2pa(uint64_t va);
+         void writeIndex(IndexEntryType type, const Record *rec = NULL, const void *payload1 = NULL, uint32_t size1 = 0, const void *payload2 = NULL, uint32_t size2 = 0);
+         void indexEvent() { if (m_index) writeIndex(IndexEvent); }
          uint64_t va2pa_lookup(uint64_t va);
 
       public:
-         Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression = false, const char *response_filename = "", uint32_t id = 0, bool arch32 = false, bool requires_icache_per_insn = false, bool send_va2pa_mapping = false);
+         // With useFramedCompression, the trace is compressed in independent blocks (see Sift::CompressionFramed)
+         // by compressionThreads background threads, or inline when compressionThreads == 0.
+         // The threads are started with pthread_create, so Pin tools must leave compressionThreads at 0
+         Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression = false, const char *response_filename = "", uint32_t id = 0, bool arch32 = false, bool requires_icache_per_insn = false, bool send_va2pa_mapping = false, bool useFramedCompression = false, int compressionLevel = 9, uint32_t compressionThreads = 0);
          ~Writer();
          void End();
+         // Write a sidecar index for Reader::Seek to index_filename, with a checkpoint every interval instructions.
+         // Must be called before any records are written.
+         void EnableIndex(const char *index_filename, uint64_t interval);
          void Instruction(uint64_t addr, uint8_t size, uint8_t num_addresses, uint64_t addresses[], bool is_branch, bool taken, bool is_predicate, bool executed);
          Mode InstructionCount(uint32_t icount);
          void CacheOnly(uint8_t icount, CacheOnlyType type, uint64_t eip, uint64_t address);
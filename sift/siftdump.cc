@@ -6,6 +6,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <cstdlib>
 #include <map>
 #include <unordered_map>
 
@@ -67,10 +68,26 @@ int main(int argc, char* argv[])
    }
    else if (argc > 1)
    {
-      Sift::Reader reader(argv[1]);
+      // -s <icount>: start at instruction icount, skipping ahead with the trace's index (<file.sift>.idx) if there is one
+      uint64_t start = 0;
+      int argi = 1;
+      if (argc > 3 && strcmp(argv[1], "-s") == 0)
+      {
+         start = strtoull(argv[2], NULL, 0);
+         argi = 3;
+      }
+
+      Sift::Reader reader(argv[argi]);
       const xed_syntax_enum_t syntax = XED_SYNTAX_ATT;
 
       Sift::Instruction inst;
+      if (start)
+      {
+         fprintf(stderr, "Index skipped to instruction %" PRIu64 "\n", reader.Seek(start));
+         while(reader.getInstructionCount() < start && reader.Read(inst))
+            ;
+      }
+
       while(reader.Read(inst))
       {
          printf("%016" PRIx64 " ", inst.sinst->addr);
@@ -100,6 +117,6 @@ int main(int argc, char* argv[])
    }
    else
    {
-      printf("Usage: %s [-d] <file.sift>\n", argv[0]);
+      printf("Usage: %s [-d | -s <icount>] <file.sift>\n", argv[0]);
    }
 }
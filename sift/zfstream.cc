@@ -2,6 +2,13 @@
 
 #include <zlib.h>
 #include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 ozstream::ozstream(vostream *output)
    : output(output)
@@ -47,6 +54,48 @@ void ozstream::doCompress(bool finish)
 
 
 
+vimstream* vimstream::open(const char *filename)
+{
+   int fd = ::open(filename, O_RDONLY);
+   if (fd < 0)
+      return NULL;
+
+   struct stat filestatus;
+   if (fstat(fd, &filestatus) != 0 || !S_ISREG(filestatus.st_mode) || filestatus.st_size == 0)
+   {
+      close(fd);
+      return NULL;
+   }
+
+   void *data = mmap(NULL, filestatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   // The mapping stays valid after closing the file
+   close(fd);
+   if (data == MAP_FAILED)
+      return NULL;
+
+   // Traces are read front to back: have the kernel read ahead aggressively and drop pages behind us
+   madvise(data, filestatus.st_size, MADV_SEQUENTIAL);
+
+   return new vimstream((const char*)data, filestatus.st_size, true);
+}
+
+vimstream::vimstream(const char *data, size_t size, bool mapped)
+   : m_data(data)
+   , m_size(size)
+   , m_pos(0)
+   , m_fail(false)
+   , m_mapped(mapped)
+{
+}
+
+vimstream::~vimstream()
+{
+   if (m_mapped)
+      munmap(const_cast<char*>(m_data), m_size);
+}
+
+
+
 izstream::izstream(vistream *input)
    : input(input)
    , m_eof(false)
@@ -114,3 +163,462 @@ int izstream::peek()
 
    return peek_value;
 }
+
+
+
+BlockCodec* BlockCodec::create(uint8_t codec, int level)
+{
+   switch(codec)
+   {
+      case Sift::CodecStored:
+         return new StoredCodec();
+      case Sift::CodecZlib:
+         return new ZlibCodec(level);
+      default:
+         return NULL;
+   }
+}
+
+size_t StoredCodec::compress(const char* in, size_t size, char* out, size_t out_size) const
+{
+   if (size > out_size)
+      return 0;
+   memcpy(out, in, size);
+   return size;
+}
+
+bool StoredCodec::decompress(const char* in, size_t size, char* out, size_t out_size) const
+{
+   if (size != out_size)
+      return false;
+   memcpy(out, in, size);
+   return true;
+}
+
+size_t ZlibCodec::compress(const char* in, size_t size, char* out, size_t out_size) const
+{
+   uLongf length = out_size;
+   if (compress2((Bytef*)out, &length, (const Bytef*)in, size, level) != Z_OK)
+      return 0;
+   return length;
+}
+
+bool ZlibCodec::decompress(const char* in, size_t size, char* out, size_t out_size) const
+{
+   uLongf length = out_size;
+   return uncompress((Bytef*)out, &length, (const Bytef*)in, size) == Z_OK && length == out_size;
+}
+
+
+
+oframestream::oframestream(vostream *output, BlockCodec *codec, uint32_t num_threads, size_t blocksize)
+   : output(output)
+   , codec(codec)
+   , blocksize(blocksize)
+   , num_threads(num_threads)
+   , blocks(num_threads ? 2 * num_threads : 1)
+   , fill(0)
+   , head(0)
+   , in_flight(0)
+   , stop(false)
+   , threads(num_threads)
+   , offset(0)
+   , uncompressed_offset(0)
+{
+   for(std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+   {
+      it->data = new char[blocksize];
+      it->size = 0;
+      it->compressed = new char[codec->compressBound(blocksize)];
+      it->done = false;
+   }
+
+   pthread_mutex_init(&mutex, NULL);
+   pthread_cond_init(&cond_queue, NULL);
+   pthread_cond_init(&cond_done, NULL);
+   for(uint32_t i = 0; i < num_threads; ++i)
+   {
+      int ret = pthread_create(&threads[i], NULL, threadFunc, this);
+      assert(ret == 0);
+   }
+}
+
+oframestream::~oframestream()
+{
+   if (blocks[fill].size)
+      submitBlock();
+   drain(0);
+
+   pthread_mutex_lock(&mutex);
+   stop = true;
+   pthread_cond_broadcast(&cond_queue);
+   pthread_mutex_unlock(&mutex);
+   for(uint32_t i = 0; i < num_threads; ++i)
+      pthread_join(threads[i], NULL);
+   pthread_cond_destroy(&cond_done);
+   pthread_cond_destroy(&cond_queue);
+   pthread_mutex_destroy(&mutex);
+
+   // End marker, block index and trailer
+   Sift::FrameHeader end = { 0, 0, Sift::CodecStored };
+   output->write(reinterpret_cast<char*>(&end), sizeof(end));
+   if (index.size())
+      output->write(reinterpret_cast<char*>(&index[0]), index.size() * sizeof(Sift::FrameIndexEntry));
+   Sift::FrameIndexTrailer trailer = { index.size(), Sift::FrameIndexMagic };
+   output->write(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+
+   for(std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+   {
+      delete [] it->data;
+      delete [] it->compressed;
+   }
+   delete codec;
+   delete output;
+}
+
+void oframestream::write(const char* s, std::streamsize n)
+{
+   while(n > 0)
+   {
+      Block &block = blocks[fill];
+      size_t amount = std::min(size_t(n), blocksize - block.size);
+      memcpy(block.data + block.size, s, amount);
+      block.size += amount;
+      s += amount;
+      n -= amount;
+
+      if (block.size == blocksize)
+         submitBlock();
+   }
+}
+
+void oframestream::compressBlock(Block &block)
+{
+   block.compressed_size = codec->compress(block.data, block.size, block.compressed, codec->compressBound(blocksize));
+   block.codec = codec->getId();
+   // Incompressible data is stored as-is
+   if (block.compressed_size == 0 || block.compressed_size >= block.size)
+   {
+      memcpy(block.compressed, block.data, block.size);
+      block.compressed_size = block.size;
+      block.codec = Sift::CodecStored;
+   }
+}
+
+void oframestream::submitBlock()
+{
+   if (num_threads == 0)
+   {
+      compressBlock(blocks[fill]);
+      writeBlock(blocks[fill]);
+      return;
+   }
+
+   pthread_mutex_lock(&mutex);
+   blocks[fill].done = false;
+   queue.push_back(&blocks[fill]);
+   ++in_flight;
+   pthread_cond_signal(&cond_queue);
+   pthread_mutex_unlock(&mutex);
+
+   fill = (fill + 1) % blocks.size();
+   // Write out completed blocks, and make sure the next block to fill is no longer in flight
+   drain(blocks.size() - 1);
+}
+
+void oframestream::drain(uint32_t max_in_flight)
+{
+   if (num_threads == 0)
+      return;
+
+   pthread_mutex_lock(&mutex);
+   while(in_flight && (blocks[head].done || in_flight > max_in_flight))
+   {
+      while(!blocks[head].done)
+         pthread_cond_wait(&cond_done, &mutex);
+      pthread_mutex_unlock(&mutex);
+
+      writeBlock(blocks[head]);
+
+      pthread_mutex_lock(&mutex);
+      head = (head + 1) % blocks.size();
+      --in_flight;
+   }
+   pthread_mutex_unlock(&mutex);
+}
+
+void oframestream::writeBlock(Block &block)
+{
+   Sift::FrameIndexEntry entry = { offset, uncompressed_offset };
+   index.push_back(entry);
+
+   Sift::FrameHeader hdr = { uint32_t(block.compressed_size), uint32_t(block.size), block.codec };
+   output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   output->write(block.compressed, block.compressed_size);
+
+   offset += sizeof(hdr) + block.compressed_size;
+   uncompressed_offset += block.size;
+   block.size = 0;
+}
+
+void* oframestream::threadFunc(void *arg)
+{
+   static_cast<oframestream*>(arg)->threadMain();
+   return NULL;
+}
+
+void oframestream::threadMain()
+{
+   pthread_mutex_lock(&mutex);
+   while(true)
+   {
+      while(queue.empty() && !stop)
+         pthread_cond_wait(&cond_queue, &mutex);
+      if (queue.empty())
+         break;
+
+      Block *block = queue.front();
+      queue.pop_front();
+      pthread_mutex_unlock(&mutex);
+
+      compressBlock(*block);
+
+      pthread_mutex_lock(&mutex);
+      block->done = true;
+      pthread_cond_broadcast(&cond_done);
+   }
+   pthread_mutex_unlock(&mutex);
+}
+
+
+
+iframestream::iframestream(vistream *input, uint64_t base, uint32_t prefetch)
+   : input(input)
+   , prefetch(prefetch)
+   , m_eof(false)
+   , m_fail(false)
+   , current(NULL)
+   , pos(0)
+   , position(0)
+   , block_start(0)
+   , input_done(false)
+   , stop(false)
+   , base(base)
+{
+   pthread_mutex_init(&mutex, NULL);
+   pthread_cond_init(&cond_ready, NULL);
+   pthread_cond_init(&cond_free, NULL);
+
+   // One block for the consumer, prefetch blocks in the pipeline
+   for(uint32_t i = 0; i < prefetch; ++i)
+      free.push_back(new Block());
+
+   if (prefetch)
+      startThread();
+   else
+      current = new Block();
+}
+
+iframestream::~iframestream()
+{
+   stopThread();
+   pthread_cond_destroy(&cond_free);
+   pthread_cond_destroy(&cond_ready);
+   pthread_mutex_destroy(&mutex);
+
+   delete current;
+   for(std::deque<Block*>::iterator it = ready.begin(); it != ready.end(); ++it)
+      delete *it;
+   for(std::deque<Block*>::iterator it = free.begin(); it != free.end(); ++it)
+      delete *it;
+   delete input;
+}
+
+bool iframestream::readBlock(Block *block)
+{
+   Sift::FrameHeader hdr;
+   input->read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (input->fail() || hdr.uncompressed_size == 0)
+      return false;
+
+   BlockCodec *codec = BlockCodec::create(hdr.codec);
+   assert(codec);
+
+   block->compressed.resize(hdr.compressed_size);
+   block->data.resize(hdr.uncompressed_size);
+   input->read(&block->compressed[0], hdr.compressed_size);
+   bool ok = !input->fail() && codec->decompress(&block->compressed[0], hdr.compressed_size, &block->data[0], hdr.uncompressed_size);
+   delete codec;
+
+   block->size = hdr.uncompressed_size;
+   block->frame_size = sizeof(hdr) + hdr.compressed_size;
+   return ok;
+}
+
+bool iframestream::nextBlock()
+{
+   if (current)
+      block_start += current->size;
+   pos = 0;
+
+   if (prefetch == 0)
+   {
+      if (!input_done && !readBlock(current))
+         input_done = true;
+      if (input_done)
+      {
+         current->size = 0;
+         return false;
+      }
+      position += current->frame_size;
+      return true;
+   }
+
+   pthread_mutex_lock(&mutex);
+   if (current)
+   {
+      free.push_back(current);
+      current = NULL;
+      pthread_cond_signal(&cond_free);
+   }
+   while(ready.empty() && !input_done)
+      pthread_cond_wait(&cond_ready, &mutex);
+   if (!ready.empty())
+   {
+      current = ready.front();
+      ready.pop_front();
+   }
+   pthread_mutex_unlock(&mutex);
+
+   if (!current)
+      return false;
+   position += current->frame_size;
+   return true;
+}
+
+void iframestream::read(char* s, std::streamsize n)
+{
+   while(n > 0)
+   {
+      if (!current || pos == current->size)
+      {
+         if (!nextBlock())
+         {
+            m_eof = true;
+            m_fail = true;
+            return;
+         }
+      }
+
+      size_t amount = std::min(size_t(n), current->size - pos);
+      memcpy(s, &current->data[pos], amount);
+      pos += amount;
+      s += amount;
+      n -= amount;
+   }
+}
+
+int iframestream::peek()
+{
+   if (!current || pos == current->size)
+   {
+      if (!nextBlock())
+      {
+         m_eof = true;
+         m_fail = true;
+         return EOF;
+      }
+   }
+
+   return current->data[pos];
+}
+
+void iframestream::startThread()
+{
+   stop = false;
+   int ret = pthread_create(&thread, NULL, threadFunc, this);
+   assert(ret == 0);
+}
+
+void iframestream::stopThread()
+{
+   if (prefetch == 0)
+      return;
+
+   pthread_mutex_lock(&mutex);
+   stop = true;
+   pthread_cond_broadcast(&cond_free);
+   pthread_mutex_unlock(&mutex);
+   pthread_join(thread, NULL);
+}
+
+bool iframestream::seekBlock(uint64_t offset, uint64_t uncompressed_offset, size_t skip)
+{
+   // Stop read-ahead and discard everything that was prefetched
+   stopThread();
+   if (prefetch)
+   {
+      if (current)
+         free.push_back(current);
+      current = NULL;
+      free.insert(free.end(), ready.begin(), ready.end());
+      ready.clear();
+   }
+
+   bool ok = input->seek(base + offset);
+   input_done = !ok;
+   m_eof = m_fail = !ok;
+   pos = 0;
+   position = offset;
+   block_start = uncompressed_offset;
+
+   if (prefetch)
+      startThread();
+   else
+      current->size = 0;
+
+   if (!ok || !nextBlock() || skip > current->size)
+   {
+      m_eof = m_fail = true;
+      return false;
+   }
+   pos = skip;
+   return true;
+}
+
+void* iframestream::threadFunc(void *arg)
+{
+   static_cast<iframestream*>(arg)->threadMain();
+   return NULL;
+}
+
+void iframestream::threadMain()
+{
+   pthread_mutex_lock(&mutex);
+   while(true)
+   {
+      while(free.empty() && !stop)
+         pthread_cond_wait(&cond_free, &mutex);
+      if (stop)
+         break;
+
+      Block *block = free.front();
+      free.pop_front();
+      pthread_mutex_unlock(&mutex);
+
+      bool ok = readBlock(block);
+
+      pthread_mutex_lock(&mutex);
+      if (ok)
+         ready.push_back(block);
+      else
+      {
+         free.push_back(block);
+         input_done = true;
+      }
+      pthread_cond_signal(&cond_ready);
+      if (!ok)
+         break;
+   }
+   pthread_mutex_unlock(&mutex);
+}
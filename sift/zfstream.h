@@ -1,10 +1,18 @@
 #ifndef __ZFSTREAM_H
 #define __ZFSTREAM_H
 
+#include "sift_format.h"
+
 #include <zlib.h>
 #include <ostream>
 #include <istream>
 #include <fstream>
+#include <vector>
+#include <deque>
+#include <pthread.h>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
 
 class vostream
 {
@@ -55,6 +63,108 @@ class ozstream : public vostream
 };
 
 
+// Compression of a single, self-contained block of data
+class BlockCodec
+{
+   public:
+      static BlockCodec* create(uint8_t codec, int level = 9);
+
+      virtual ~BlockCodec() {}
+      virtual uint8_t getId() const = 0;
+      virtual size_t compressBound(size_t size) const = 0;
+      // Returns the compressed size, or 0 if the data could not be compressed into out_size bytes
+      virtual size_t compress(const char* in, size_t size, char* out, size_t out_size) const = 0;
+      virtual bool decompress(const char* in, size_t size, char* out, size_t out_size) const = 0;
+};
+
+class StoredCodec : public BlockCodec
+{
+   public:
+      virtual uint8_t getId() const { return Sift::CodecStored; }
+      virtual size_t compressBound(size_t size) const { return size; }
+      virtual size_t compress(const char* in, size_t size, char* out, size_t out_size) const;
+      virtual bool decompress(const char* in, size_t size, char* out, size_t out_size) const;
+};
+
+class ZlibCodec : public BlockCodec
+{
+   private:
+      int level;
+   public:
+      ZlibCodec(int level) : level(level) {}
+      virtual uint8_t getId() const { return Sift::CodecZlib; }
+      virtual size_t compressBound(size_t size) const { return ::compressBound(size); }
+      virtual size_t compress(const char* in, size_t size, char* out, size_t out_size) const;
+      virtual bool decompress(const char* in, size_t size, char* out, size_t out_size) const;
+};
+
+// Framed compression (Sift::CompressionFramed): data is cut into blocks of blocksize bytes which are compressed
+// independently, by num_threads background threads (or inline when num_threads == 0), and written out in order.
+// Threads are created with pthread_create, which Pin does not support: the recorder always uses num_threads == 0.
+class oframestream : public vostream
+{
+   private:
+      struct Block
+      {
+         char *data;
+         size_t size;
+         char *compressed;
+         size_t compressed_size;
+         uint8_t codec;
+         bool done;
+      };
+
+      vostream *output;
+      BlockCodec *codec;
+      const size_t blocksize;
+      const uint32_t num_threads;
+
+      std::vector<Block> blocks;          // Ring of blocks, blocks[fill] is being filled, blocks[head] is the oldest one in flight
+      uint32_t fill, head, in_flight;
+      std::deque<Block*> queue;           // Blocks waiting to be compressed
+      bool stop;
+      pthread_mutex_t mutex;
+      pthread_cond_t cond_queue, cond_done;
+      std::vector<pthread_t> threads;
+
+      uint64_t offset, uncompressed_offset;
+      std::vector<Sift::FrameIndexEntry> index;
+
+      void compressBlock(Block &block);
+      void submitBlock();
+      void writeBlock(Block &block);
+      void drain(uint32_t max_in_flight);
+      static void* threadFunc(void *arg);
+      void threadMain();
+   public:
+      oframestream(vostream *output, BlockCodec *codec, uint32_t num_threads = 0, size_t blocksize = 1024*1024);
+      virtual ~oframestream();
+      virtual void write(const char* s, std::streamsize n);
+      virtual void flush()
+         { output->flush(); }
+      virtual bool is_open()
+         { return output->is_open(); }
+      size_t getBlockSize() const { return blocksize; }
+};
+
+// Pass-through stream that counts the number of bytes written
+class vocountstream : public vostream
+{
+   private:
+      vostream *output;
+      uint64_t count;
+   public:
+      vocountstream(vostream *output) : output(output), count(0) {}
+      virtual ~vocountstream() { delete output; }
+      virtual void write(const char* s, std::streamsize n)
+         { output->write(s, n); count += n; }
+      virtual void flush()
+         { output->flush(); }
+      virtual bool is_open()
+         { return output->is_open(); }
+      uint64_t getCount() const { return count; }
+};
+
 
 class vistream
 {
@@ -63,6 +173,8 @@ class vistream
       virtual void read(char* s, std::streamsize n) = 0;
       virtual int peek() = 0;
       virtual bool fail() const = 0;
+      // Reposition to absolute position pos, returns false if the stream does not support this
+      virtual bool seek(uint64_t pos) { return false; }
 };
 
 class vifstream : public vistream
@@ -80,6 +192,67 @@ class vifstream : public vistream
       virtual int peek()
          { return stream->peek(); }
       virtual bool fail() const { return stream->fail(); }
+      virtual bool seek(uint64_t pos)
+         { stream->clear(); stream->seekg(pos); return !stream->fail(); }
+};
+
+// Input stream backed by a read-only memory mapping of a regular file. Besides the vistream interface,
+// data can be accessed in place through consume(), without copying it out of the mapping.
+class vimstream : public vistream
+{
+   private:
+      const char *m_data;
+      size_t m_size;
+      size_t m_pos;
+      bool m_fail;
+      bool m_mapped;
+   public:
+      // Returns NULL if filename cannot be mapped (not a regular file, or no address space)
+      static vimstream* open(const char *filename);
+      // Stream over a buffer in memory, which is unmapped on destruction if mapped is set
+      vimstream(const char *data, size_t size, bool mapped = false);
+      virtual ~vimstream();
+      virtual void read(char* s, std::streamsize n)
+      {
+         // Like std::istream, a short read copies what is left and sets fail
+         size_t amount = std::min(size_t(n), m_size - m_pos);
+         memcpy(s, m_data + m_pos, amount);
+         m_pos += amount;
+         if (amount < size_t(n))
+            m_fail = true;
+      }
+      virtual int peek()
+      {
+         if (m_pos < m_size)
+            return m_data[m_pos];
+         m_fail = true;
+         return EOF;
+      }
+      virtual bool fail() const { return m_fail; }
+      virtual bool seek(uint64_t pos)
+      {
+         if (pos > m_size)
+            return false;
+         m_pos = pos;
+         m_fail = false;
+         return true;
+      }
+
+      // Pointer to the next n bytes in the mapping, which are consumed. Returns NULL at the end of the file.
+      const char* consume(size_t n)
+      {
+         if (n > m_size - m_pos)
+         {
+            m_pos = m_size;
+            m_fail = true;
+            return NULL;
+         }
+         const char *data = m_data + m_pos;
+         m_pos += n;
+         return data;
+      }
+      bool contains(const void *ptr) const { return ptr >= m_data && ptr < m_data + m_size; }
+      uint64_t tell() const { return m_pos; }
 };
 
 class izstream : public vistream
@@ -102,4 +275,58 @@ class izstream : public vistream
       virtual bool fail() const { return m_fail; }
 };
 
+// Reader for framed compression. A background thread reads and decompresses up to prefetch blocks ahead
+// of the consumer (or blocks are decompressed on demand when prefetch == 0).
+class iframestream : public vistream
+{
+   private:
+      struct Block
+      {
+         Block() : size(0), frame_size(0) {}
+         std::vector<char> data;
+         std::vector<char> compressed;
+         size_t size;
+         uint64_t frame_size;
+      };
+
+      vistream *input;
+      const uint32_t prefetch;
+      bool m_eof;
+      bool m_fail;
+
+      Block *current;
+      size_t pos;
+      uint64_t position;                  // Compressed bytes consumed so far
+      uint64_t block_start;               // Uncompressed position of the start of current
+
+      std::deque<Block*> ready, free;
+      bool input_done, stop;
+      pthread_mutex_t mutex;
+      pthread_cond_t cond_ready, cond_free;
+      pthread_t thread;
+
+      const uint64_t base;
+
+      bool readBlock(Block *block);
+      bool nextBlock();
+      void startThread();
+      void stopThread();
+      static void* threadFunc(void *arg);
+      void threadMain();
+   public:
+      // base is the position of the framed data in input
+      iframestream(vistream *input, uint64_t base, uint32_t prefetch);
+      virtual ~iframestream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool eof() const { return m_eof; }
+      virtual bool fail() const { return m_fail; }
+      uint64_t getPosition() const { return position; }
+      // Position in the uncompressed data
+      uint64_t tell() const { return block_start + pos; }
+      // Continue reading at byte skip of the block whose FrameHeader is at offset, and which starts at
+      // uncompressed_offset in the uncompressed data. Returns false if input is not seekable.
+      bool seekBlock(uint64_t offset, uint64_t uncompressed_offset, size_t skip);
+};
+
 #endif // __ZFSTREAM_H
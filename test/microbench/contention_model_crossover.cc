@@ -0,0 +1,89 @@
+// Time ContentionModel for a range of slot counts, to find where the slot index starts paying off
+// compared to scanning all slots.
+//
+// The Makefile builds this twice: contention_model_linear with the index disabled, and
+// contention_model_indexed with the index used for any number of slots.
+// Both print the same checksums, the slot count from which the indexed build is faster
+// is a good value for CONTENTION_MODEL_INDEX_THRESHOLD.
+//
+// Each request follows the L1 MSHR sequence in the cache controller:
+// getTagCompletionTime(address), getStartTime(t_miss_begin), getCompletionTime(t_miss_begin, latency, address)
+
+#include "contention_model.h"
+#include "simulator.h"
+#include "config.hpp"
+
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+Simulator *Simulator::m_singleton = NULL;
+
+struct Request
+{
+   SubsecondTime t_now;
+   UInt64 address;
+   SubsecondTime latency;
+};
+
+static double getTime()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+   const UInt64 num_requests = argc > 1 ? atoll(argv[1]) : 2000000;
+   const UInt32 num_slots[] = { 1, 2, 4, 8, 12, 16, 24, 32, 48, 64, 128 };
+
+   config::Config cfg;
+   Simulator sim(&cfg);
+   Simulator::setSingleton(&sim);
+
+   printf("# index threshold %u\n", CONTENTION_MODEL_INDEX_THRESHOLD);
+   printf("# %5s %10s %18s\n", "slots", "ns/request", "checksum");
+
+   for(UInt32 i = 0; i < sizeof(num_slots) / sizeof(num_slots[0]); ++i)
+   {
+      // Generate the requests up front with a fixed seed, so both builds see the same ones
+      // and only the model is timed. A miss every few ns, each taking about as long as
+      // the slots can absorb, so the model is mostly full.
+      std::vector<Request> requests(num_requests);
+      SubsecondTime t_now = SubsecondTime::Zero();
+      srand48(42);
+      for(UInt64 r = 0; r < num_requests; ++r)
+      {
+         t_now += SubsecondTime::PS(100 + lrand48() % 2000);
+         requests[r].t_now = t_now;
+         requests[r].address = (lrand48() % 4096) << 6;
+         requests[r].latency = SubsecondTime::PS(num_slots[i] * (500 + lrand48() % 2000));
+      }
+
+      ContentionModel model("mshr", 0, num_slots[i]);
+      UInt64 checksum = 0;
+
+      double t_start = getTime();
+      for(UInt64 r = 0; r < num_requests; ++r)
+      {
+         SubsecondTime t_completed = model.getTagCompletionTime(requests[r].address);
+         if (t_completed != SubsecondTime::MaxTime() && t_completed > requests[r].t_now)
+         {
+            // Overlapping miss: wait for the one in flight
+            checksum += t_completed.getPS();
+            continue;
+         }
+
+         SubsecondTime t_avail = model.getStartTime(requests[r].t_now);
+         SubsecondTime t_end = model.getCompletionTime(t_avail, requests[r].latency, requests[r].address);
+         checksum = checksum * 31 + t_end.getPS();
+      }
+      double elapsed = getTime() - t_start;
+
+      printf("  %5u %10.1f %18" PRIx64 "\n", num_slots[i], 1e9 * elapsed / num_requests, checksum);
+   }
+
+   return 0;
+}
@@ -0,0 +1,115 @@
+// Compare FlatHashMap against std::unordered_map on the instruction address streams of SIFT traces.
+//
+// Usage: flat_hash_map_sift [-n <max instructions>] <trace.sift> [...]
+//
+// The instruction addresses of each trace are read up front, then replayed through both maps
+// the way TraceThread looks up its decoded instructions: std::unordered_map with the original
+// count() followed by operator[], FlatHashMap with a single operator[].
+
+#include "flat_hash_map.h"
+#include "sift_reader.h"
+
+#include <unordered_map>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+static double getTime()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// Stand-in for the decoded instruction TraceThread creates on a miss
+static void* decode(uint64_t addr)
+{
+   return (void*)(addr | 1);
+}
+
+static uint64_t replayUnorderedMap(const std::vector<uint64_t> &addresses, double &elapsed, uint64_t &size)
+{
+   std::unordered_map<uint64_t, void*> icache;
+   uint64_t checksum = 0;
+
+   double t_start = getTime();
+   for(std::vector<uint64_t>::const_iterator it = addresses.begin(); it != addresses.end(); ++it)
+   {
+      if (icache.count(*it) == 0)
+         icache[*it] = decode(*it);
+      checksum += (uintptr_t)icache[*it];
+   }
+   elapsed = getTime() - t_start;
+   size = icache.size();
+
+   return checksum;
+}
+
+static uint64_t replayFlatHashMap(const std::vector<uint64_t> &addresses, double &elapsed, uint64_t &size)
+{
+   FlatHashMap<uint64_t, void*> icache;
+   uint64_t checksum = 0;
+
+   double t_start = getTime();
+   for(std::vector<uint64_t>::const_iterator it = addresses.begin(); it != addresses.end(); ++it)
+   {
+      void* &ins = icache[*it];
+      if (!ins)
+         ins = decode(*it);
+      checksum += (uintptr_t)ins;
+   }
+   elapsed = getTime() - t_start;
+   size = icache.size();
+
+   return checksum;
+}
+
+int main(int argc, char **argv)
+{
+   uint64_t max_instructions = UINT64_MAX;
+   int argi = 1;
+   if (argi + 1 < argc && strcmp(argv[argi], "-n") == 0)
+   {
+      max_instructions = strtoull(argv[argi + 1], NULL, 0);
+      argi += 2;
+   }
+   if (argi >= argc)
+   {
+      fprintf(stderr, "Usage: %s [-n <max instructions>] <trace.sift> [...]\n", argv[0]);
+      return 1;
+   }
+
+   bool ok = true;
+   for(; argi < argc; ++argi)
+   {
+      std::vector<uint64_t> addresses;
+      {
+         Sift::Reader reader(argv[argi]);
+         Sift::Instruction inst;
+         while (addresses.size() < max_instructions && reader.Read(inst))
+            addresses.push_back(inst.sinst->addr);
+      }
+      if (addresses.empty())
+      {
+         fprintf(stderr, "No instructions in %s\n", argv[argi]);
+         ok = false;
+         continue;
+      }
+
+      double t_unordered, t_flat;
+      uint64_t size_unordered, size_flat;
+      uint64_t checksum_unordered = replayUnorderedMap(addresses, t_unordered, size_unordered);
+      uint64_t checksum_flat = replayFlatHashMap(addresses, t_flat, size_flat);
+      bool match = checksum_unordered == checksum_flat && size_unordered == size_flat;
+
+      printf("%s: %" PRIu64 " instructions, %" PRIu64 " unique addresses\n", argv[argi], (uint64_t)addresses.size(), size_flat);
+      printf("   std::unordered_map %8.2f ns/instruction\n", 1e9 * t_unordered / addresses.size());
+      printf("   FlatHashMap        %8.2f ns/instruction  %s\n", 1e9 * t_flat / addresses.size(), match ? "ok" : "MISMATCH");
+      ok &= match;
+   }
+
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+// Replay request streams through the windowed M/G/1 queue model, comparing it against the original
+// std::multimap based window: both must return the same delays, and the time per request is reported.
+//
+// Usage: queue_model_replay [-w <window size in ns>] [<sim.queuetrace.* file> ...]
+//
+// Traces are recorded by running Sniper with -g queue_model/windowed_mg1/record_trace=true,
+// each line holds the global time, the packet time and the processing time of one request (in ps).
+// Without traces, synthetic streams with increasing amounts of reordering are replayed.
+
+#include "queue_model_windowed_mg1.h"
+#include "simulator.h"
+#include "config.hpp"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+Simulator *Simulator::m_singleton = NULL;
+
+struct Request
+{
+   SubsecondTime global_time;
+   SubsecondTime pkt_time;
+   SubsecondTime processing_time;
+};
+
+// The window as it was implemented before the ring buffer
+class QueueModelWindowedMG1Reference
+{
+public:
+   QueueModelWindowedMG1Reference(SubsecondTime window_size)
+      : m_window_size(window_size)
+      , m_num_arrivals(0)
+      , m_service_time_sum(0)
+      , m_service_time_sum2(0)
+   {}
+
+   SubsecondTime computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time)
+   {
+      SubsecondTime t_queue = SubsecondTime::Zero();
+
+      removeItems(std::max(Sim()->getClockSkewMinimizationServer()->getGlobalTime() - m_window_size, pkt_time - 10*m_window_size));
+
+      if (m_num_arrivals > 1)
+      {
+         double utilization = (double)m_service_time_sum / m_window_size.getPS();
+         double arrival_rate = (double)m_num_arrivals / m_window_size.getPS();
+
+         double service_time_Es2 = m_service_time_sum2 / m_num_arrivals;
+
+         if (utilization > .99)
+            utilization = .99;
+
+         t_queue = SubsecondTime::PS(arrival_rate * service_time_Es2 / (2 * (1. - utilization)));
+
+         if (t_queue > m_window_size)
+            t_queue = m_window_size;
+      }
+
+      m_window.insert(std::pair<SubsecondTime, SubsecondTime>(pkt_time, processing_time));
+      m_num_arrivals ++;
+      m_service_time_sum += processing_time.getPS();
+      m_service_time_sum2 += processing_time.getPS() * processing_time.getPS();
+
+      return t_queue;
+   }
+
+private:
+   const SubsecondTime m_window_size;
+
+   std::multimap<SubsecondTime, SubsecondTime> m_window;
+   UInt64 m_num_arrivals;
+   UInt64 m_service_time_sum;
+   UInt64 m_service_time_sum2;
+
+   void removeItems(SubsecondTime earliest_time)
+   {
+      while(!m_window.empty() && m_window.begin()->first < earliest_time)
+      {
+         std::multimap<SubsecondTime, SubsecondTime>::iterator entry = m_window.begin();
+         m_num_arrivals --;
+         m_service_time_sum -= entry->second.getPS();
+         m_service_time_sum2 -= entry->second.getPS() * entry->second.getPS();
+         m_window.erase(entry);
+      }
+   }
+};
+
+static double getTime()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static bool readTrace(const char *filename, std::vector<Request> &requests)
+{
+   FILE *fp = fopen(filename, "r");
+   if (!fp)
+      return false;
+
+   UInt64 global_time, pkt_time, processing_time;
+   while (fscanf(fp, "%" SCNu64 " %" SCNu64 " %" SCNu64, &global_time, &pkt_time, &processing_time) == 3)
+   {
+      Request request = { SubsecondTime::PS(global_time), SubsecondTime::PS(pkt_time), SubsecondTime::PS(processing_time) };
+      requests.push_back(request);
+   }
+   fclose(fp);
+   return true;
+}
+
+// Requests from a number of cores, each running ahead of the global time by up to one barrier quantum,
+// with a fixed seed so runs are comparable
+static void generateTrace(UInt32 num_cores, UInt64 quantum_ns, UInt64 num_requests, std::vector<Request> &requests)
+{
+   srand48(42);
+   std::vector<SubsecondTime> core_time(num_cores, SubsecondTime::Zero());
+   SubsecondTime global_time = SubsecondTime::Zero();
+   SubsecondTime quantum = SubsecondTime::NS(quantum_ns);
+
+   for(UInt64 i = 0; i < num_requests; ++i)
+   {
+      UInt32 core = lrand48() % num_cores;
+      if (core_time[core] >= global_time + quantum)
+      {
+         // This core reached the barrier: release it, the global time only advances when all cores have
+         global_time = *std::min_element(core_time.begin(), core_time.end());
+         global_time = SubsecondTime::NS(global_time.getNS() / quantum_ns * quantum_ns);
+      }
+      core_time[core] += SubsecondTime::PS(1000 + lrand48() % 20000);
+
+      Request request = { global_time, core_time[core], SubsecondTime::PS(1000 + lrand48() % 4000) };
+      requests.push_back(request);
+   }
+}
+
+template <class Model> static double replay(Model &model, const std::vector<Request> &requests, std::vector<SubsecondTime> &delays)
+{
+   ClockSkewMinimizationServer *server = Sim()->getClockSkewMinimizationServer();
+   delays.resize(requests.size());
+
+   double t_start = getTime();
+   for(UInt64 i = 0; i < requests.size(); ++i)
+   {
+      server->setGlobalTime(requests[i].global_time);
+      delays[i] = model.computeQueueDelay(requests[i].pkt_time, requests[i].processing_time);
+   }
+   return getTime() - t_start;
+}
+
+static bool run(const char *name, SubsecondTime window_size, const std::vector<Request> &requests)
+{
+   QueueModelWindowedMG1 model("queue", 0);
+   QueueModelWindowedMG1Reference reference(window_size);
+   std::vector<SubsecondTime> delays, reference_delays;
+
+   double t_model = replay(model, requests, delays);
+   double t_reference = replay(reference, requests, reference_delays);
+
+   UInt64 mismatches = 0;
+   for(UInt64 i = 0; i < requests.size(); ++i)
+      if (delays[i] != reference_delays[i])
+         ++mismatches;
+
+   printf("%-32s %10" PRIu64 " requests  %8.1f ns/request (multimap %8.1f ns/request)  %s\n", name, (UInt64)requests.size(),
+      1e9 * t_model / requests.size(), 1e9 * t_reference / requests.size(), mismatches ? "MISMATCH" : "ok");
+   return mismatches == 0;
+}
+
+int main(int argc, char **argv)
+{
+   UInt64 window_size_ns = 1000;
+   int argi = 1;
+   if (argi + 1 < argc && strcmp(argv[argi], "-w") == 0)
+   {
+      window_size_ns = atoll(argv[argi + 1]);
+      argi += 2;
+   }
+
+   config::Config cfg;
+   cfg.set("queue_model/windowed_mg1/window_size", window_size_ns);
+   cfg.set("queue_model/windowed_mg1/record_trace", false);
+   Simulator sim(&cfg);
+   Simulator::setSingleton(&sim);
+
+   SubsecondTime window_size = SubsecondTime::NS(window_size_ns);
+   bool ok = true;
+
+   if (argi < argc)
+   {
+      for(; argi < argc; ++argi)
+      {
+         std::vector<Request> requests;
+         if (!readTrace(argv[argi], requests))
+         {
+            fprintf(stderr, "Cannot read %s\n", argv[argi]);
+            return 1;
+         }
+         ok &= run(argv[argi], window_size, requests);
+      }
+   }
+   else
+   {
+      const UInt32 num_cores[] = { 1, 4, 16, 64 };
+      for(UInt32 i = 0; i < sizeof(num_cores) / sizeof(num_cores[0]); ++i)
+      {
+         std::vector<Request> requests;
+         generateTrace(num_cores[i], 100, 2000000, requests);
+         char name[64];
+         snprintf(name, sizeof(name), "synthetic, %u cores", num_cores[i]);
+         ok &= run(name, window_size, requests);
+      }
+   }
+
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+// Minimal stand-in for the configuration file, holding only the keys a microbenchmark sets
+
+#include "fixed_types.h"
+#include "log.h"
+
+#include <map>
+
+namespace config
+{
+   class Config
+   {
+   public:
+      void set(const String & path, SInt64 value) { m_values[path] = value; }
+
+      SInt64 getInt(const String & path)
+      {
+         LOG_ASSERT_ERROR(m_values.count(path), "Configuration key %s not set", path.c_str());
+         return m_values[path];
+      }
+      bool getBool(const String & path) { return getInt(path); }
+
+   private:
+      std::map<String, SInt64> m_values;
+   };
+}
+
+#endif // CONFIG_HPP
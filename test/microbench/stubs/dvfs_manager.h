@@ -0,0 +1,7 @@
+#ifndef __DVFS_MANAGER_H
+#define __DVFS_MANAGER_H
+
+// DvfsManager is part of the simulator stand-in
+#include "simulator.h"
+
+#endif // __DVFS_MANAGER_H
@@ -0,0 +1,19 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Errors abort the microbenchmark, everything else is dropped
+
+#include "fixed_types.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOG_PRINT(...) ((void)(0))
+#define LOG_PRINT_WARNING(...) ((void)(0))
+#define LOG_PRINT_WARNING_ONCE(...) ((void)(0))
+#define LOG_PRINT_ERROR(...) (fprintf(stderr, "[%s:%d] ", __FILE__, __LINE__), fprintf(stderr, __VA_ARGS__), fprintf(stderr, "\n"), exit(-1))
+#define LOG_ASSERT_WARNING(...) ((void)(0))
+#define LOG_ASSERT_WARNING_ONCE(...) ((void)(0))
+#define LOG_ASSERT_ERROR(expr, ...) do { if (!(expr)) LOG_PRINT_ERROR(__VA_ARGS__); } while(0)
+
+#endif // LOG_H
@@ -0,0 +1,61 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+// Minimal stand-in for the simulator, so models can be linked into host-side microbenchmarks
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "log.h"
+
+namespace config { class Config; }
+
+class Config
+{
+public:
+   String formatOutputFileName(String filename) const { return filename; }
+};
+
+class ClockSkewMinimizationServer
+{
+public:
+   ClockSkewMinimizationServer() : m_global_time(SubsecondTime::Zero()) {}
+   SubsecondTime getGlobalTime(bool upper_bound = false) { return m_global_time; }
+   void setGlobalTime(SubsecondTime time) { m_global_time = time; }
+private:
+   SubsecondTime m_global_time;
+};
+
+class DvfsManager
+{
+public:
+   const ComponentPeriod* getCoreDomain(UInt32 core_id) { return NULL; }
+};
+
+class Simulator
+{
+public:
+   Simulator(config::Config *cfg) : m_config_file(cfg) {}
+
+   static Simulator* getSingleton() { return m_singleton; }
+   static void setSingleton(Simulator *sim) { m_singleton = sim; }
+
+   Config *getConfig() { return &m_config; }
+   config::Config *getCfg() { return m_config_file; }
+   ClockSkewMinimizationServer* getClockSkewMinimizationServer() { return &m_clock_skew_minimization_server; }
+   DvfsManager *getDvfsManager() { return &m_dvfs_manager; }
+
+private:
+   static Simulator *m_singleton;
+
+   Config m_config;
+   config::Config *m_config_file;
+   ClockSkewMinimizationServer m_clock_skew_minimization_server;
+   DvfsManager m_dvfs_manager;
+};
+
+__attribute__((unused)) static Simulator *Sim()
+{
+   return Simulator::getSingleton();
+}
+
+#endif // SIMULATOR_H
@@ -0,0 +1,9 @@
+#pragma once
+
+// Statistics are not collected in microbenchmarks
+
+#include "fixed_types.h"
+
+template <class T> void registerStatsMetric(String objectName, UInt32 index, String metricName, T *metric)
+{
+}
@@ -0,0 +1,148 @@
+// Pass buffers between threads the way SmTransport does, comparing SlabPool against new [] / delete [].
+//
+// Usage: transport_buffers [<threads> [<messages per thread> [<message size>]]]
+//
+// Each thread stands in for one core: it allocates a message, links it into the MPSCQueue
+// of a random other thread, and frees whatever was sent to it, so most buffers are freed
+// by a different thread than the one that allocated them.
+// The default message size is that of a coherence message carrying a 64-byte cache line.
+
+#include "slab_pool.h"
+#include "mpsc_queue.h"
+
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+struct Message
+{
+   MPSCQueue::Link link;
+   Byte *buffer;
+   UInt64 sender;
+};
+
+struct Thread
+{
+   pthread_t thread;
+   UInt64 id;
+   MPSCQueue queue;
+   SlabPool *pool;
+   UInt64 received;
+   UInt64 checksum;
+};
+
+static std::vector<Thread*> threads;
+static UInt64 num_messages;
+static UInt32 message_size;
+static volatile UInt64 num_done;
+
+static double getTime()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void receive(Thread *self)
+{
+   while (MPSCQueue::Link *link = self->queue.tryPop())
+   {
+      Message *message = (Message*)link;
+      self->received++;
+      self->checksum += message->sender;
+      if (self->pool)
+         SlabPool::free(message->buffer);
+      else
+         delete [] message->buffer;
+   }
+}
+
+static void* threadFunc(void *arg)
+{
+   Thread *self = (Thread*)arg;
+   UInt64 seed = self->id * 0x9e3779b97f4a7c15ULL + 1;
+
+   for(UInt64 i = 0; i < num_messages; ++i)
+   {
+      Byte *buffer = self->pool ? self->pool->alloc(message_size) : new Byte[message_size];
+      // Like SmTransport's Trailer, the link lives in the buffer
+      Message *message = (Message*)(buffer + message_size - sizeof(Message));
+      message->buffer = buffer;
+      message->sender = self->id;
+
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      threads[(seed >> 33) % threads.size()]->queue.push(&message->link);
+
+      receive(self);
+   }
+
+   __sync_fetch_and_add(&num_done, 1);
+   // Keep freeing what the others send us until everyone has sent all their messages
+   while (num_done < threads.size())
+   {
+      receive(self);
+      sched_yield();
+   }
+   receive(self);
+
+   return NULL;
+}
+
+static bool run(bool use_pool)
+{
+   num_done = 0;
+   for(UInt64 i = 0; i < threads.size(); ++i)
+   {
+      threads[i]->pool = use_pool ? new SlabPool(message_size, 256) : NULL;
+      threads[i]->received = 0;
+      threads[i]->checksum = 0;
+   }
+
+   double t_start = getTime();
+   for(UInt64 i = 0; i < threads.size(); ++i)
+      pthread_create(&threads[i]->thread, NULL, threadFunc, threads[i]);
+   for(UInt64 i = 0; i < threads.size(); ++i)
+      pthread_join(threads[i]->thread, NULL);
+   double elapsed = getTime() - t_start;
+
+   UInt64 received = 0, checksum = 0;
+   for(UInt64 i = 0; i < threads.size(); ++i)
+   {
+      received += threads[i]->received;
+      checksum += threads[i]->checksum;
+      delete threads[i]->pool;
+   }
+
+   UInt64 total = threads.size() * num_messages;
+   bool ok = received == total && checksum == num_messages * (threads.size() * (threads.size() - 1) / 2);
+   printf("%-10s %8.1f ns/message  %s\n", use_pool ? "SlabPool" : "new []", 1e9 * elapsed / total, ok ? "ok" : "MISMATCH");
+   return ok;
+}
+
+int main(int argc, char **argv)
+{
+   UInt64 num_threads = argc > 1 ? atoll(argv[1]) : 64;
+   num_messages = argc > 2 ? atoll(argv[2]) : 200000;
+   // NetPacket + ShmemMsg + 64-byte cache line + SmTransport's Trailer
+   message_size = argc > 3 ? atoi(argv[3]) : 192;
+
+   if (num_threads < 1 || message_size < sizeof(Message))
+   {
+      fprintf(stderr, "Usage: %s [<threads> [<messages per thread> [<message size>]]]\n", argv[0]);
+      return 1;
+   }
+
+   for(UInt64 i = 0; i < num_threads; ++i)
+   {
+      threads.push_back(new Thread());
+      threads.back()->id = i;
+   }
+
+   printf("# %" PRIu64 " threads, %" PRIu64 " messages of %u bytes each\n", num_threads, num_messages, message_size);
+   bool ok = run(false);
+   ok &= run(true);
+
+   return ok ? 0 : 1;
+}